@@ -0,0 +1,218 @@
+// Alert Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    Read from the clock library
+
+// Hardware configuration:
+// Speaker through the melody library
+
+// Each alert has a condition set by the caller from its sensor readings.
+// A condition that stays true is one alert, not a new one per reading: it
+// plays at most once per cooldown until it is acknowledged or clears.
+// Clearing also resets the acknowledgment, so the next occurrence is
+// announced again.  serviceAlerts plays the highest priority alert that is
+// due, one tune at a time with ALERT_HOLD_MS of silence after each, so the
+// speaker on-time is bounded by the tune lengths and cooldowns whatever the
+// sensors do.
+//
+// Cooldowns are timed in RTC seconds, which keep counting through deep
+// sleep.  The caller keeps the last play time in HIB_DATA, packed into 16
+// bits as the RTC minute rounded up, so a wake does not replay an alert
+// that is still cooling down.  The rounding only ever makes a restored
+// cooldown end up to a minute later.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "clock.h"
+#include "console.h"
+#include "rtc.h"
+#include "melody.h"
+#include "alert.h"
+
+typedef struct _ALERT
+{
+    const char* name;
+    uint8_t priority;
+    uint32_t cooldownSeconds;
+    const TUNE* tune;
+    bool active;
+    bool acknowledged;
+    bool played;
+    uint32_t plays;
+    uint32_t lastPlaySeconds;                       // RTC seconds
+} ALERT;
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+ALERT alerts[MAX_ALERTS];
+bool anyAlertPlayed = false;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+bool defineAlert(uint8_t alert, const char name[], uint8_t priority, uint32_t cooldownSeconds, const TUNE* tune)
+{
+    if (alert >= MAX_ALERTS)
+        return false;
+    alerts[alert].name = name;
+    alerts[alert].priority = priority;
+    alerts[alert].cooldownSeconds = cooldownSeconds;
+    alerts[alert].tune = tune;
+    alerts[alert].active = false;
+    alerts[alert].acknowledged = false;
+    alerts[alert].played = false;
+    alerts[alert].plays = 0;
+    return true;
+}
+
+void setAlertCondition(uint8_t alert, bool active)
+{
+    if (alert >= MAX_ALERTS || alerts[alert].name == 0)
+        return;
+    if (!active)
+    {
+        alerts[alert].acknowledged = false;
+        alerts[alert].played = false;                   // a new occurrence plays at once
+    }
+    alerts[alert].active = active;
+}
+
+static uint32_t getSecondsSincePlay(uint8_t alert)
+{
+    int32_t seconds;
+    if (!alerts[alert].played)
+        return 0xFFFFFFFF;
+    seconds = getRtcSeconds() - alerts[alert].lastPlaySeconds;
+    return seconds < 0 ? 0 : seconds;                   // a restored time is rounded up
+}
+
+// True while a tune plays or during the quiet time after it
+bool isAlertBusy()
+{
+    if (isMelodyPlaying())
+        return true;
+    return anyAlertPlayed && timestampToMicroseconds(getTimestamp() - getMelodyStopTime()) < ALERT_HOLD_MS*1000ULL;
+}
+
+// Plays the highest priority alert that is due
+// Returns the alert started or NO_ALERT
+uint8_t serviceAlerts(bool audible)
+{
+    uint8_t alert, best = NO_ALERT;
+    if (!audible || isAlertBusy())
+        return NO_ALERT;
+    for (alert = 0; alert < MAX_ALERTS; alert++)
+    {
+        if (alerts[alert].active && !alerts[alert].acknowledged
+            && (!alerts[alert].played || getSecondsSincePlay(alert) >= alerts[alert].cooldownSeconds)
+            && (best == NO_ALERT || alerts[alert].priority > alerts[best].priority))
+            best = alert;
+    }
+    if (best == NO_ALERT || !playTune(alerts[best].tune))
+        return NO_ALERT;
+    alerts[best].played = true;
+    alerts[best].plays++;
+    alerts[best].lastPlaySeconds = getRtcSeconds();
+    anyAlertPlayed = true;
+    return best;
+}
+
+// Silences an active alert until its condition clears, ALL_ALERTS for all
+// Returns false if nothing was active
+bool acknowledgeAlert(uint8_t alert)
+{
+    uint8_t i;
+    bool found = false;
+    for (i = 0; i < MAX_ALERTS; i++)
+    {
+        if ((alert == ALL_ALERTS || alert == i) && alerts[i].active)
+        {
+            alerts[i].acknowledged = true;
+            found = true;
+        }
+    }
+    if (found)
+        stopMelody();
+    return found;
+}
+
+uint8_t findAlert(const char name[])
+{
+    uint8_t alert;
+    for (alert = 0; alert < MAX_ALERTS; alert++)
+        if (alerts[alert].name != 0 && stringCompare(alerts[alert].name, name) == 0)
+            return alert;
+    return NO_ALERT;
+}
+
+bool getAlertInfo(uint8_t alert, ALERT_INFO* info)
+{
+    if (alert >= MAX_ALERTS || alerts[alert].name == 0)
+        return false;
+    info->name = alerts[alert].name;
+    info->priority = alerts[alert].priority;
+    info->cooldownSeconds = alerts[alert].cooldownSeconds;
+    info->active = alerts[alert].active;
+    info->acknowledged = alerts[alert].acknowledged;
+    info->plays = alerts[alert].plays;
+    info->secondsSincePlay = getSecondsSincePlay(alert);
+    return true;
+}
+
+// Acknowledgments are kept across deep sleep, bit n for alert n
+uint32_t getAcknowledgedAlerts()
+{
+    uint8_t alert;
+    uint32_t mask = 0;
+    for (alert = 0; alert < MAX_ALERTS; alert++)
+        if (alerts[alert].acknowledged)
+            mask |= 1 << alert;
+    return mask;
+}
+
+void restoreAcknowledgedAlerts(uint32_t mask)
+{
+    uint8_t alert;
+    for (alert = 0; alert < MAX_ALERTS; alert++)
+    {
+        if (alerts[alert].name != 0 && (mask & (1 << alert)))
+        {
+            alerts[alert].active = true;
+            alerts[alert].acknowledged = true;
+        }
+    }
+}
+
+// Last play time kept across deep sleep, NOT_PLAYED if the alert has not
+// played since its condition last cleared
+uint16_t packAlertPlayTime(uint8_t alert)
+{
+    uint16_t minute;
+    if (alert >= MAX_ALERTS || !alerts[alert].played)
+        return NOT_PLAYED;
+    minute = (alerts[alert].lastPlaySeconds + 59) / 60;
+    if (minute == NOT_PLAYED)
+        minute = 0;                                     // a minute later, never earlier
+    return minute;
+}
+
+void restorePackedAlertPlayTime(uint8_t alert, uint16_t packed)
+{
+    uint32_t now = (getRtcSeconds() + 59) / 60;
+    if (alert >= MAX_ALERTS || alerts[alert].name == 0 || packed == NOT_PLAYED)
+        return;
+    alerts[alert].played = true;
+    alerts[alert].lastPlaySeconds = (now - (uint16_t)(now - packed)) * 60;
+}
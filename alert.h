@@ -0,0 +1,54 @@
+// Alert Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    Read from the clock library
+
+// Hardware configuration:
+// Speaker through the melody library
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef ALERT_H_
+#define ALERT_H_
+
+#define MAX_ALERTS 4
+#define ALL_ALERTS 0xFF
+#define NO_ALERT 0xFF
+#define ALERT_HOLD_MS 10000                     // quiet time after any alert
+#define NOT_PLAYED 0xFFFF
+
+typedef struct _ALERT_INFO
+{
+    const char* name;
+    uint8_t priority;                           // higher plays first
+    uint32_t cooldownSeconds;
+    bool active;
+    bool acknowledged;
+    uint32_t plays;
+    uint32_t secondsSincePlay;                  // 0xFFFFFFFF if never played
+} ALERT_INFO;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+bool defineAlert(uint8_t alert, const char name[], uint8_t priority, uint32_t cooldownSeconds, const TUNE* tune);
+void setAlertCondition(uint8_t alert, bool active);
+uint8_t serviceAlerts(bool audible);
+bool acknowledgeAlert(uint8_t alert);
+uint8_t findAlert(const char name[]);
+bool getAlertInfo(uint8_t alert, ALERT_INFO* info);
+uint32_t getAcknowledgedAlerts();
+void restoreAcknowledgedAlerts(uint32_t mask);
+uint16_t packAlertPlayTime(uint8_t alert);
+void restorePackedAlertPlayTime(uint8_t alert, uint16_t packed);
+bool isAlertBusy();
+
+#endif
@@ -0,0 +1,175 @@
+// Calendar Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// Hibernation module RTC (read through the RTC library)
+
+// The RTC counts seconds from 1 Jan 1970.  The calendar keeps the date of
+// the current day and the RTC count at its midnight, so most calls cost
+// one subtraction.  Crossing midnight steps the date forward one day at a
+// time; only when the RTC has been set (it moved backwards or jumped more
+// than a week) is the date recomputed from the day number.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "rtc.h"
+#include "calendar.h"
+
+#define MAX_STEP_DAYS 7
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+bool calendarValid = false;
+uint32_t dayStart;                              // RTC seconds at midnight of today
+uint32_t dayNumber;                             // days since 1 Jan 1970
+DATE today;
+
+const uint8_t daysInMonth[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+const char* dayNames[7] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static bool isLeapYear(uint16_t year)
+{
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+uint8_t getDaysInMonth(uint16_t year, uint8_t month)
+{
+    if (month == 2 && isLeapYear(year))
+        return 29;
+    return daysInMonth[month - 1];
+}
+
+const char* getDayName(uint8_t dayOfWeek)
+{
+    return dayNames[dayOfWeek % 7];
+}
+
+// Days since 1 Jan 1970 for a civil date (March based years so the leap
+// day is the last day of the year)
+static uint32_t dateToDays(uint16_t year, uint8_t month, uint8_t day)
+{
+    uint32_t era, yearOfEra, dayOfYear, dayOfEra;
+    if (month <= 2)
+        year--;
+    era = year / 400;
+    yearOfEra = year - era*400;
+    dayOfYear = (153*(month > 2 ? month - 3 : month + 9) + 2)/5 + day - 1;
+    dayOfEra = yearOfEra*365 + yearOfEra/4 - yearOfEra/100 + dayOfYear;
+    return era*146097 + dayOfEra - 719468;
+}
+
+// Inverse of dateToDays, only used when the RTC has been set
+static void daysToDate(uint32_t days, DATE* date)
+{
+    uint32_t z, era, dayOfEra, yearOfEra, dayOfYear, mp;
+    z = days + 719468;
+    era = z / 146097;
+    dayOfEra = z - era*146097;
+    yearOfEra = (dayOfEra - dayOfEra/1460 + dayOfEra/36524 - dayOfEra/146096) / 365;
+    dayOfYear = dayOfEra - (365*yearOfEra + yearOfEra/4 - yearOfEra/100);
+    mp = (5*dayOfYear + 2)/153;
+    date->day = dayOfYear - (153*mp + 2)/5 + 1;
+    date->month = mp < 10 ? mp + 3 : mp - 9;
+    date->year = yearOfEra + era*400 + (date->month <= 2);
+    date->dayOfWeek = (days + 4) % 7;           // 1 Jan 1970 was a Thursday
+}
+
+static void stepDay()
+{
+    dayNumber++;
+    dayStart += SECONDS_PER_DAY;
+    today.dayOfWeek = today.dayOfWeek == 6 ? 0 : today.dayOfWeek + 1;
+    if (++today.day > getDaysInMonth(today.year, today.month))
+    {
+        today.day = 1;
+        if (++today.month > 12)
+        {
+            today.month = 1;
+            today.year++;
+        }
+    }
+}
+
+// Bring today up to date with the RTC, returns the RTC seconds used
+static uint32_t updateCalendar()
+{
+    uint32_t seconds = getRtcSeconds();
+    if (!calendarValid || seconds < dayStart || seconds - dayStart >= MAX_STEP_DAYS*SECONDS_PER_DAY)
+    {
+        dayNumber = seconds / SECONDS_PER_DAY;
+        dayStart = dayNumber * SECONDS_PER_DAY;
+        daysToDate(dayNumber, &today);
+        calendarValid = true;
+    }
+    while (seconds - dayStart >= SECONDS_PER_DAY)
+        stepDay();
+    return seconds;
+}
+
+void getDate(DATE* date)
+{
+    updateCalendar();
+    *date = today;
+}
+
+uint32_t getDayNumber()
+{
+    updateCalendar();
+    return dayNumber;
+}
+
+uint32_t getSecondOfDay()
+{
+    return updateCalendar() - dayStart;
+}
+
+uint8_t getDayOfWeek()
+{
+    updateCalendar();
+    return today.dayOfWeek;
+}
+
+uint16_t getMinuteOfWeek()
+{
+    uint32_t seconds = updateCalendar() - dayStart;
+    return today.dayOfWeek*1440 + seconds/60;
+}
+
+// Change the date and keep the time of day
+bool setDate(uint32_t year, uint32_t month, uint32_t day)
+{
+    uint32_t secondOfDay;
+    if (year < CALENDAR_MIN_YEAR || year > CALENDAR_MAX_YEAR || month < 1 || month > 12
+        || day < 1 || day > getDaysInMonth(year, month))
+        return false;
+    secondOfDay = getSecondOfDay();
+    setRtcSeconds(dateToDays(year, month, day)*SECONDS_PER_DAY + secondOfDay);
+    return true;
+}
+
+// Change the time of day and keep the date
+bool setTimeOfDay(uint32_t hours, uint32_t minutes, uint32_t seconds)
+{
+    if (hours > 23 || minutes > 59 || seconds > 59)
+        return false;
+    updateCalendar();
+    setRtcSeconds(dayStart + hours*3600 + minutes*60 + seconds);
+    return true;
+}
@@ -0,0 +1,47 @@
+// Calendar Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// Hibernation module RTC (read through the RTC library)
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef CALENDAR_H_
+#define CALENDAR_H_
+
+#define SECONDS_PER_DAY 86400
+#define CALENDAR_MIN_YEAR 1970
+#define CALENDAR_MAX_YEAR 2105                  // 32-bit RTC seconds run out in 2106
+
+typedef struct _DATE
+{
+    uint16_t year;
+    uint8_t month;                              // 1-12
+    uint8_t day;                                // 1-31
+    uint8_t dayOfWeek;                          // Sunday = 0
+} DATE;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void getDate(DATE* date);
+uint32_t getDayNumber();
+uint32_t getSecondOfDay();
+uint8_t getDayOfWeek();
+uint16_t getMinuteOfWeek();
+bool setDate(uint32_t year, uint32_t month, uint32_t day);
+bool setTimeOfDay(uint32_t hours, uint32_t minutes, uint32_t seconds);
+uint8_t getDaysInMonth(uint16_t year, uint8_t month);
+const char* getDayName(uint8_t dayOfWeek);
+
+#endif
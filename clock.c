@@ -0,0 +1,210 @@
+// Clock Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    Read from RCC/RCC2
+
+// Hardware configuration:
+// DWT cycle counter (CYCCNT)
+// Timer1A free-running 32-bit up-counter, extended to 64 bits
+
+// The system clock is decoded from RCC/RCC2 when initClock is called, so
+// delays and conversions follow any change to the clock setup in initHw.
+// CYCCNT counts core clocks and stops while the core sleeps in WFI, so it
+// is only used for delays and for measuring code, not as a wall clock.
+
+// getTimestamp is the monotonic clock for everything else.  Timer1 keeps
+// counting system clocks through WFI, and its wrap interrupt extends it to
+// 64 bits.  Nothing may write TIMER1_TAV_R; measure intervals as
+// differences between timestamps.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "clock.h"
+
+// Core debug and DWT registers (not in the device header)
+#define DEMCR_TRCENA            0x01000000
+#define DWT_CTRL_R              (*((volatile uint32_t *)0xE0001000))
+#define DWT_CYCCNT_R            (*((volatile uint32_t *)0xE0001004))
+#define DWT_CTRL_CYCCNTENA      0x00000001
+
+#define PIOSC_HZ                16000000
+#define LFIOSC_HZ               30000
+#define PLL_HZ                  400000000
+
+// Crystal frequencies for RCC XTAL field values 0x06 to 0x1A
+const uint32_t xtalHz[] =
+{
+    4000000, 4096000, 4915200, 5000000, 5120000, 6000000, 6144000,
+    7372800, 8000000, 8192000, 10000000, 12000000, 12288000, 13560000,
+    14318180, 16000000, 16384000, 18000000, 20000000, 24000000, 25000000
+};
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+uint32_t sysClockHz = 16000000;
+uint32_t cyclesPerUs = 16;
+volatile uint32_t timestampHigh = 0;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static uint32_t getOscillatorHz(uint32_t oscsrc)
+{
+    uint32_t xtal = (SYSCTL_RCC_R & SYSCTL_RCC_XTAL_M) >> 6;
+    switch (oscsrc)
+    {
+        case SYSCTL_RCC_OSCSRC_MAIN:
+            if (xtal >= 0x06 && xtal <= 0x1A)
+                return xtalHz[xtal - 0x06];
+            return PIOSC_HZ;
+        case SYSCTL_RCC_OSCSRC_INT:
+            return PIOSC_HZ;
+        case SYSCTL_RCC_OSCSRC_INT4:
+            return PIOSC_HZ / 4;
+        default:
+            return LFIOSC_HZ;
+    }
+}
+
+// Decode the current system clock from RCC, or RCC2 when it overrides RCC
+static uint32_t readSysClockHz()
+{
+    uint32_t rcc = SYSCTL_RCC_R;
+    uint32_t rcc2 = SYSCTL_RCC2_R;
+    uint32_t hz, div;
+    if (rcc2 & SYSCTL_RCC2_USERCC2)
+    {
+        if ((rcc2 & SYSCTL_RCC2_OSCSRC2_M) == SYSCTL_RCC2_OSCSRC2_32)
+            hz = 32768;
+        else
+            hz = getOscillatorHz(rcc2 & SYSCTL_RCC_OSCSRC_M);
+        if (!(rcc2 & SYSCTL_RCC2_BYPASS2))
+        {
+            if (rcc2 & SYSCTL_RCC2_DIV400)
+            {
+                hz = PLL_HZ;
+                div = ((rcc2 & SYSCTL_RCC2_SYSDIV2_M) >> (SYSCTL_RCC2_SYSDIV2_S - 1)) | ((rcc2 & SYSCTL_RCC2_SYSDIV2LSB) ? 1 : 0);
+                return hz / (div + 1);
+            }
+            hz = PLL_HZ / 2;
+        }
+        if (rcc & SYSCTL_RCC_USESYSDIV)
+            hz /= ((rcc2 & SYSCTL_RCC2_SYSDIV2_M) >> SYSCTL_RCC2_SYSDIV2_S) + 1;
+        return hz;
+    }
+    hz = getOscillatorHz(rcc & SYSCTL_RCC_OSCSRC_M);
+    if (!(rcc & SYSCTL_RCC_BYPASS))
+        hz = PLL_HZ / 2;
+    if (rcc & SYSCTL_RCC_USESYSDIV)
+        hz /= ((rcc & SYSCTL_RCC_SYSDIV_M) >> SYSCTL_RCC_SYSDIV_S) + 1;
+    return hz;
+}
+
+// Start the cycle counter and the timestamp timer, and latch the system
+// clock rate.  Call again after any change to the clock configuration.
+void initClock()
+{
+    NVIC_DBG_INT_R |= DEMCR_TRCENA;
+    DWT_CYCCNT_R = 0;
+    DWT_CTRL_R |= DWT_CTRL_CYCCNTENA;
+    sysClockHz = readSysClockHz();
+    cyclesPerUs = sysClockHz / 1000000;
+    if (cyclesPerUs == 0)
+        cyclesPerUs = 1;
+
+    if (!(SYSCTL_RCGCTIMER_R & SYSCTL_RCGCTIMER_R1))
+    {
+        SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R1;
+        _delay_cycles(3);
+        TIMER1_CTL_R &= ~TIMER_CTL_TAEN;
+        TIMER1_CFG_R = TIMER_CFG_32_BIT_TIMER;
+        TIMER1_TAMR_R = TIMER_TAMR_TAMR_PERIOD | TIMER_TAMR_TACDIR;
+        TIMER1_TAILR_R = 0xFFFFFFFF;
+        TIMER1_IMR_R = TIMER_IMR_TATOIM;
+        NVIC_EN0_R |= 1 << (INT_TIMER1A-16);
+        TIMER1_CTL_R |= TIMER_CTL_TAEN;
+    }
+}
+
+// Counts Timer1 wraps (every 2^32 clocks)
+void timer1Isr()
+{
+    TIMER1_ICR_R = TIMER_ICR_TATOCINT;
+    timestampHigh++;
+}
+
+// System clocks since the timer started, callable from any context
+// If the wrap interrupt is pending but not yet serviced (interrupts masked
+// or a higher priority ISR is running), the wrap is accounted for here.
+uint64_t getTimestamp()
+{
+    uint32_t high, low;
+    bool wrapped;
+    do
+    {
+        high = timestampHigh;
+        low = TIMER1_TAV_R;
+        wrapped = (TIMER1_RIS_R & TIMER_RIS_TATORIS) != 0;
+    } while (high != timestampHigh);
+    if (wrapped && low < 0x80000000)
+        high++;
+    return ((uint64_t)high << 32) | low;
+}
+
+uint64_t timestampToMicroseconds(uint64_t timestamp)
+{
+    return timestamp / cyclesPerUs;
+}
+
+uint32_t getSysClockHz()
+{
+    return sysClockHz;
+}
+
+uint32_t getCycles()
+{
+    return DWT_CYCCNT_R;
+}
+
+uint32_t cyclesToMicroseconds(uint32_t cycles)
+{
+    return cycles / cyclesPerUs;
+}
+
+uint32_t cyclesToNanoseconds(uint32_t cycles)
+{
+    return ((uint64_t)cycles * 1000000000) / sysClockHz;
+}
+
+// Busy wait, wrap safe for up to 2^32 cycles
+void waitCycles(uint32_t cycles)
+{
+    uint32_t start = DWT_CYCCNT_R;
+    while ((DWT_CYCCNT_R - start) < cycles);
+}
+
+void waitMicrosecond(uint32_t us)
+{
+    uint32_t chunk;
+    while (us > 0)
+    {
+        chunk = us;
+        if (chunk > 0xFFFFFFFF / cyclesPerUs)
+            chunk = 0xFFFFFFFF / cyclesPerUs;
+        waitCycles(chunk * cyclesPerUs);
+        us -= chunk;
+    }
+}
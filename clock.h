@@ -0,0 +1,37 @@
+// Clock Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    Read from RCC/RCC2
+
+// Hardware configuration:
+// DWT cycle counter (CYCCNT)
+// Timer1A free-running 32-bit up-counter, extended to 64 bits
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initClock();
+uint32_t getSysClockHz();
+uint32_t getCycles();
+uint32_t cyclesToMicroseconds(uint32_t cycles);
+uint32_t cyclesToNanoseconds(uint32_t cycles);
+void waitCycles(uint32_t cycles);
+void waitMicrosecond(uint32_t us);
+uint64_t getTimestamp();
+uint64_t timestampToMicroseconds(uint64_t timestamp);
+void timer1Isr();
+
+#endif
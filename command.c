@@ -0,0 +1,137 @@
+// Command Table Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// None, command matching only (the caller executes the command)
+
+// The console commands and the arguments each one accepts, in one table
+// used by both the firmware and the host build.  A command's forms are
+// separated by '|' and list its leading arguments by field: n is a number,
+// a is a word and anything else is that exact word.  Fields after the
+// ones a form lists are optional, so "pump ON" also matches "pump ON 2".
+// Range checks (zone numbers, percentages, times) are left to the caller,
+// which knows the limits.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "console.h"
+#include "command.h"
+
+#define MAX_TOKEN_CHARS 10
+
+typedef struct _COMMAND
+{
+    const char* name;
+    const char* forms;
+} COMMAND;
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+// In the order of the command numbers in command.h
+const COMMAND commands[COMMAND_COUNT] =
+{
+    {"alert", "n"},
+    {"ack", ""},
+    {"alerts", ""},
+    {"status", ""},
+    {"pump", "ON|OFF|duty n|flow n|ramp n|cal n|max n|clear"},
+    {"time", "n n"},
+    {"volume", "n"},
+    {"date", ""},
+    {"sync", "n"},
+    {"water", "n n n n"},
+    {"window", "n n n n|clear|list"},
+    {"dose", "stop|n"},
+    {"level", "n"},
+    {"target", "n|reset"},
+    {"zones", ""},
+    {"zone", "save|n reset|n level n|n target n|n windows n"},
+    {"script", "begin|run|show|clear"},
+    {"tune", "water begin|water play|water clear|battery begin|battery play|battery clear"},
+    {"tasks", ""},
+    {"power", ""},
+    {"deepsleep", "n"},
+#ifdef NDEBUG
+    {"verbose", "quiet|normal"},
+#else
+    {"verbose", "quiet|normal|debug"},
+#endif
+};
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Checks the arguments against the form at *form and moves *form past it
+static bool matchForm(USER_DATA* data, const char** form)
+{
+    char token[MAX_TOKEN_CHARS+1];
+    uint8_t field = 1;
+    uint8_t count;
+    bool match = true;
+    while (**form != '\0' && **form != '|')
+    {
+        count = 0;
+        while (**form != '\0' && **form != '|' && **form != ' ')
+        {
+            if (count < MAX_TOKEN_CHARS)
+                token[count++] = **form;
+            (*form)++;
+        }
+        token[count] = '\0';
+        if (**form == ' ')
+            (*form)++;
+
+        if (field >= data->fieldCount || field >= MAX_FIELDS)
+            match = false;
+        else if (stringCompare(token, "n") == 0)
+            match = match && data->fieldType[field] == 'n';
+        else if (stringCompare(token, "a") == 0)
+            match = match && data->fieldType[field] == 'a';
+        else
+            match = match && stringCompare(getFieldString(data, field), token) == 0;
+        field++;
+    }
+    if (**form == '|')
+        (*form)++;
+    return match;
+}
+
+// Returns the command number, NO_COMMAND if the name is unknown or the
+// arguments fit none of its forms
+uint8_t findCommand(USER_DATA* data)
+{
+    uint8_t command;
+    const char* form;
+    for (command = 0; command < COMMAND_COUNT; command++)
+    {
+        if (!isCommand(data, commands[command].name, 0))
+            continue;
+        form = commands[command].forms;
+        do
+        {
+            if (matchForm(data, &form))
+                return command;
+        } while (*form != '\0');
+        return NO_COMMAND;
+    }
+    return NO_COMMAND;
+}
+
+const char* getCommandName(uint8_t command)
+{
+    return command < COMMAND_COUNT ? commands[command].name : "";
+}
@@ -0,0 +1,53 @@
+// Command Table Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// None, command matching only (the caller executes the command)
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef COMMAND_H_
+#define COMMAND_H_
+
+#define ALERT_COMMAND 0
+#define ACK_COMMAND 1
+#define ALERTS_COMMAND 2
+#define STATUS_COMMAND 3
+#define PUMP_COMMAND 4
+#define TIME_COMMAND 5
+#define VOLUME_COMMAND 6
+#define DATE_COMMAND 7
+#define SYNC_COMMAND 8
+#define WATER_COMMAND 9
+#define WINDOW_COMMAND 10
+#define DOSE_COMMAND 11
+#define LEVEL_COMMAND 12
+#define TARGET_COMMAND 13
+#define ZONES_COMMAND 14
+#define ZONE_COMMAND 15
+#define SCRIPT_COMMAND 16
+#define TUNE_COMMAND 17
+#define TASKS_COMMAND 18
+#define POWER_COMMAND 19
+#define DEEPSLEEP_COMMAND 20
+#define VERBOSE_COMMAND 21
+#define COMMAND_COUNT 22
+#define NO_COMMAND 0xFF
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+uint8_t findCommand(USER_DATA* data);
+const char* getCommandName(uint8_t command);
+
+#endif
@@ -0,0 +1,265 @@
+// Console Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// Serial input through the UART0 library (getcUart0), the rest is
+// command parsing only
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "uart0.h"
+#include "console.h"
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+char FieldString[MAX_CHARS+1];
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+int stringCompare(const char *str1, const char *str2)
+{
+    int i = 0;
+    while(str1[i] == str2[i])
+    {
+        if(str1[i] == '\0' && str2[i] == '\0')
+            break;
+        i++;
+    }
+    return str1[i] - str2[i];
+}
+
+int atoi(const char* str)
+{
+    uint32_t res = 0; // Initialize result (unsigned so overflow wraps)
+    int i;
+    // Iterate through all characters of input string and
+    // update result
+    for (i = 0; str[i] != '\0'; i++)
+        res = res * 10 + str[i] - '0';
+
+    // return result.
+    return res;
+}
+
+void parseFields(USER_DATA* data)
+{
+    int counter = 0;
+    int field_count = 0;
+    int counter_two;
+    while (true)
+    {
+        if ((counter == 0) || (data->fieldType[field_count-1] != 'a'))
+        {
+            if (((data->buffer[counter] >= 65) && (data->buffer[counter] <= 90)) || ((data->buffer[counter] >= 97) && (data->buffer[counter] <= 122)))
+            {
+                if((field_count > 0) && (data->fieldType[field_count-1] == 'd'))
+                {
+                    data->fieldType[field_count-1] = 'a';
+                    data->fieldPosition[field_count-1] = counter;
+                }
+                else
+                {
+                    data->fieldType[field_count] = 'a';
+                    data->fieldPosition[field_count] = counter;
+                    field_count++;
+                }
+            }
+        }
+        if ((counter == 0) || (data->fieldType[field_count-1] != 'n'))
+        {
+            if ((data->buffer[counter] >= 48) && (data->buffer[counter] <= 57))
+            {
+                if((field_count > 0) && (data->fieldType[field_count-1] == 'd'))
+                {
+                    data->fieldType[field_count-1] = 'n';
+                    data->fieldPosition[field_count-1] = counter;
+                }
+                else
+                {
+                    data->fieldType[field_count] = 'n';
+                    data->fieldPosition[field_count] = counter;
+                    field_count++;
+                }
+            }
+        }
+        if (!((data->buffer[counter] >= 65) && (data->buffer[counter] <= 90)) && ((field_count == 0) || (data->fieldType[field_count-1] != 'd')))
+        {
+            if (!((data->buffer[counter] >= 97) && (data->buffer[counter] <= 122)))
+            {
+                if (!((data->buffer[counter] >= 48) && (data->buffer[counter] <= 57)))
+                {
+                    data->fieldType[field_count] = 'd';
+                    field_count++;
+                }
+            }
+        }
+        if ((field_count == MAX_FIELDS) || (data->buffer[counter] == '\0'))
+        {
+            for (counter_two = 0; counter_two <= counter; counter_two ++)
+            {
+                if (!((data->buffer[counter_two] >= 65) && (data->buffer[counter_two] <= 90)))
+                {
+                    if (!((data->buffer[counter_two] >= 97) && (data->buffer[counter_two] <= 122)))
+                    {
+                        if (!((data->buffer[counter_two] >= 48) && (data->buffer[counter_two] <= 57)))
+                        {
+                            data->buffer[counter_two] = '\0';
+                        }
+                    }
+                }
+                if ((counter_two < MAX_FIELDS) && (data->fieldType[counter_two] == 'd'))
+                {
+                    data->fieldType[counter_two] = '\0';
+                }
+             }
+            data->fieldCount = field_count-1;
+            return;
+        }
+        counter++;
+
+     }
+
+}
+
+
+// Only alpha and numeric fields have a position, delimiters and unused
+// entries do not
+static bool isField(USER_DATA* data, uint8_t fieldNumber)
+{
+    if(fieldNumber >= MAX_FIELDS || fieldNumber > data->fieldCount)
+        return false;
+    return (data->fieldType[fieldNumber] == 'a') || (data->fieldType[fieldNumber] == 'n');
+}
+
+char* getFieldString(USER_DATA* data, uint8_t fieldNumber)
+{
+   int counter=0;
+   int counter2;
+   if(isField(data, fieldNumber))
+   {
+       counter2= data->fieldPosition[fieldNumber];
+       while(data->buffer[counter2] != '\0')
+       {
+           FieldString[counter]=data->buffer[counter2];
+           counter++;
+           counter2++;
+
+       }
+       FieldString[counter]= '\0';
+       return FieldString;
+   }
+   else
+   {
+     FieldString[0]='\0';
+     return FieldString;
+   }
+
+
+}
+
+uint32_t getFieldInteger(USER_DATA* data, uint8_t fieldNumber)
+{
+    uint32_t integer_pointer;
+    int counter=0;
+    int counter2;
+    if(isField(data, fieldNumber))
+       {
+           counter2= data->fieldPosition[fieldNumber];
+           while(data->buffer[counter2]!= '\0')
+           {
+               FieldString[counter]=data->buffer[counter2];
+               counter++;
+               counter2++;
+           }
+           FieldString[counter]= '\0';
+           integer_pointer= atoi(FieldString);
+           return integer_pointer;
+       }
+       else
+       {
+         integer_pointer=0;
+         return integer_pointer;
+       }
+
+}
+
+bool isCommand(USER_DATA* data, const char strCommand[], uint8_t minArguments)
+{
+    char* firstField= '\0';
+    firstField = getFieldString(data,0);
+    if(stringCompare(firstField,strCommand)==0 && data->fieldCount >= minArguments)
+    {
+        return true;
+    }
+
+    return false;
+}
+
+// Blocking line input: returns once a complete line is in data->buffer.
+// Backspace and delete remove the last character, other control
+// characters are dropped, and a line ends at a carriage return or when
+// MAX_CHARS characters have been typed.
+bool getsUart0(USER_DATA* data)
+{
+    uint8_t count=0;
+    char c;
+    while(true)
+    {
+        c=getcUart0();
+        if((c==8 || c==127) && count>0)
+        {
+            count--;
+        }
+
+        else if(c==13)
+        {
+            data->buffer[count]='\0';
+            return true;
+        }
+
+        else if(c>=32)
+        {
+            data->buffer[count]=c;
+            count++;
+            if(count==MAX_CHARS)
+            {
+                data->buffer[count]='\0';
+                return true;
+            }
+        }
+    }
+}
+
+// Copies the command at the start of line, up to the next ';', into data
+// and parses it.  Returns the rest of the line, which is empty after the
+// last command.  A command longer than MAX_CHARS is cut short.
+const char* splitLine(const char* line, USER_DATA* data)
+{
+    uint8_t count=0;
+    while(*line!='\0' && *line!=';')
+    {
+        if(count<MAX_CHARS)
+            data->buffer[count++]=*line;
+        line++;
+    }
+    data->buffer[count]='\0';
+    if(*line==';')
+        line++;
+    parseFields(data);
+    return line;
+}
@@ -0,0 +1,46 @@
+// Console Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// Serial input through the UART0 library (getcUart0), the rest is
+// command parsing only
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef CONSOLE_H_
+#define CONSOLE_H_
+
+#define MAX_CHARS 80
+#define MAX_FIELDS 8
+
+typedef struct _USER_DATA
+{
+    char buffer[MAX_CHARS+1];
+    uint8_t fieldCount;
+    uint8_t fieldPosition[MAX_FIELDS];
+    char fieldType[MAX_FIELDS];
+} USER_DATA;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+int stringCompare(const char *str1, const char *str2);
+int atoi(const char* str);
+void parseFields(USER_DATA* data);
+char* getFieldString(USER_DATA* data, uint8_t fieldNumber);
+uint32_t getFieldInteger(USER_DATA* data, uint8_t fieldNumber);
+bool isCommand(USER_DATA* data, const char strCommand[], uint8_t minArguments);
+bool getsUart0(USER_DATA* data);
+const char* splitLine(const char* line, USER_DATA* data);
+
+#endif
@@ -0,0 +1,42 @@
+// Coroutine Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// None
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "coroutine.h"
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// The next call runs the coroutine from CO_BEGIN
+void startCoroutine(COROUTINE* co)
+{
+    co->resume = 0;
+    co->timed = false;
+}
+
+bool isCoroutineDone(const COROUTINE* co)
+{
+    return co->resume == CO_DONE;
+}
+
+// True when a timed wait has run out and the coroutine should be called
+bool isCoroutineDue(const COROUTINE* co, uint32_t now)
+{
+    return co->timed && (int32_t)(now - co->wakeTick) >= 0;
+}
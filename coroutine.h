@@ -0,0 +1,71 @@
+// Coroutine Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// None
+
+// Stackless coroutines for sequences that wait ("pulse 5 s, soak, read
+// again") written top to bottom.  The frame is a COROUTINE the caller
+// owns, usually one per zone in a static array, holding where to resume
+// and when; nothing is allocated.  A coroutine is a void function that
+// starts with CO_BEGIN and ends with CO_END.  Each wait returns from the
+// function, and the next call jumps back to the wait.
+//
+// Rules that come with the switch the macros expand to: local variables
+// do not survive a wait (keep them in arrays next to the frame), only one
+// wait per source line, and no switch statement of its own may contain a
+// wait.
+//
+// The owner calls the function again when isCoroutineDue says a timed
+// wait is over.  CO_AWAIT waits for an event: whoever makes the condition
+// true calls the function, so nothing polls.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef COROUTINE_H_
+#define COROUTINE_H_
+
+#include "kernel.h"
+
+#define CO_DONE 0xFFFF
+
+typedef struct _COROUTINE
+{
+    uint16_t resume;                            // source line of the wait, 0 to start
+    bool timed;
+    uint32_t wakeTick;
+} COROUTINE;
+
+#define CO_BEGIN(co)            switch ((co)->resume) { case 0:
+
+#define CO_END(co)              } (co)->resume = CO_DONE; (co)->timed = false; return
+
+// Wait until tick (kernel ticks)
+#define CO_SLEEP_UNTIL(co, tick) \
+    do { (co)->wakeTick = (tick); (co)->timed = true; (co)->resume = __LINE__; case __LINE__: \
+         if ((int32_t)(getTicks() - (co)->wakeTick) < 0) { return; } (co)->timed = false; } while (0)
+
+#define CO_SLEEP(co, ms)        CO_SLEEP_UNTIL(co, getTicks() + (ms))
+
+// Wait until cond is true, checked each time the coroutine is called
+#define CO_AWAIT(co, cond) \
+    do { (co)->timed = false; (co)->resume = __LINE__; case __LINE__: if (!(cond)) { return; } } while (0)
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void startCoroutine(COROUTINE* co);
+bool isCoroutineDone(const COROUTINE* co);
+bool isCoroutineDue(const COROUTINE* co, uint32_t now);
+
+#endif
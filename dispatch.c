@@ -0,0 +1,214 @@
+// Watering Dispatch Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// None
+
+// Zones that want a pulse queue a request with their moisture deficit and
+// the time left before their watering window closes.  The caller starts
+// the next request whenever one of its MAX_ACTIVE_ZONES valve slots is
+// free, and this library decides which request that is:
+//   1. requests older than MAX_WAIT_MS, oldest first
+//   2. the earliest deadline, in steps of DEADLINE_STEP_MINUTES
+//   3. the largest deficit
+// A zone soaks after every pulse, so it can not take a slot twice in a
+// row.  A request therefore waits at most MAX_WAIT_MS before it is ranked
+// by age alone, and then at most one pulse per older request per slot,
+// so time-to-water grows with NUM_ZONES / MAX_ACTIVE_ZONES and nothing
+// else.  A request still waiting at its deadline is dropped.
+//
+// Reservoir: there is one pump, so the valves open at once share its flow
+// and the water still to be drawn is the pump flow for as long as the
+// longest running pulse has left.  fitPulse shortens a pulse to what is
+// left of the spare volume, or refuses it if less than a minimum pulse is
+// left, in which case the caller starts nothing else either so the most
+// urgent zone is never overtaken by smaller pulses.
+//
+// For the same reason a zone's pulse length is not the pump time it got.
+// While n pulses run each one is credited 1/n of the elapsed time, and
+// endPulse returns the total as the full-flow time the soil model learns
+// from.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "zone.h"
+#include "watering.h"
+#include "dispatch.h"
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+uint8_t waitingZones = 0;
+uint8_t activeZones = 0;
+float requestDeficit[NUM_ZONES];
+uint32_t requestTick[NUM_ZONES];
+uint32_t requestDeadline[NUM_ZONES];
+uint32_t pulseStart[NUM_ZONES];
+uint32_t pulseLength[NUM_ZONES];
+float pulseFlow[NUM_ZONES];
+uint32_t pulseShareMs[NUM_ZONES];
+uint32_t shareTick = 0;
+uint32_t longestWait = 0;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Queues the zone, a zone already waiting keeps its place in the age order
+void requestWatering(uint8_t zone, float deficit, uint16_t minutesLeft, uint32_t now)
+{
+    if (zone >= NUM_ZONES)
+        return;
+    if (!(waitingZones & (1 << zone)))
+        requestTick[zone] = now;
+    requestDeficit[zone] = deficit;
+    requestDeadline[zone] = now + (uint32_t)minutesLeft*60000;
+    waitingZones |= 1 << zone;
+}
+
+void cancelWatering(uint8_t zone)
+{
+    if (zone < NUM_ZONES)
+        waitingZones &= ~(1 << zone);
+}
+
+bool isWateringRequested(uint8_t zone)
+{
+    return zone < NUM_ZONES && (waitingZones & (1 << zone));
+}
+
+// Removes and returns the requests whose window has closed
+uint8_t takeExpiredRequests(uint32_t now)
+{
+    uint8_t zone, expired = 0;
+    for (zone = 0; zone < NUM_ZONES; zone++)
+        if ((waitingZones & (1 << zone)) && (int32_t)(now - requestDeadline[zone]) >= 0)
+            expired |= 1 << zone;
+    waitingZones &= ~expired;
+    return expired;
+}
+
+// True when request a goes before request b
+static bool isMoreUrgent(uint8_t a, uint8_t b, uint32_t now)
+{
+    uint32_t waitA = now - requestTick[a];
+    uint32_t waitB = now - requestTick[b];
+    uint32_t stepA, stepB;
+    if (waitA >= MAX_WAIT_MS || waitB >= MAX_WAIT_MS)
+        return waitA > waitB;
+    stepA = (requestDeadline[a] - now) / (DEADLINE_STEP_MINUTES*60000);
+    stepB = (requestDeadline[b] - now) / (DEADLINE_STEP_MINUTES*60000);
+    if (stepA != stepB)
+        return stepA < stepB;
+    return requestDeficit[a] > requestDeficit[b];
+}
+
+// Most urgent waiting zone, NO_ZONE if none
+uint8_t getNextRequest(uint32_t now)
+{
+    uint8_t zone, best = NO_ZONE;
+    for (zone = 0; zone < NUM_ZONES; zone++)
+        if ((waitingZones & (1 << zone)) && (best == NO_ZONE || isMoreUrgent(zone, best, now)))
+            best = zone;
+    return best;
+}
+
+// Water the running pulses have still to draw
+uint32_t getCommittedMl(uint32_t now)
+{
+    uint8_t zone;
+    uint32_t elapsed;
+    float ml = 0, zoneMl;
+    for (zone = 0; zone < NUM_ZONES; zone++)
+    {
+        if (!(activeZones & (1 << zone)))
+            continue;
+        elapsed = now - pulseStart[zone];
+        zoneMl = elapsed < pulseLength[zone] ? pulseFlow[zone] * (pulseLength[zone] - elapsed) / 1000 : 0;
+        if (zoneMl > ml)
+            ml = zoneMl;                            // shared pump, not one per valve
+    }
+    return ml + 0.5f;
+}
+
+// Credits the running pulses with their share of the pump since the last
+// change in the number running
+static void updateShares(uint32_t now)
+{
+    uint8_t zone, count = 0;
+    uint32_t share;
+    for (zone = 0; zone < NUM_ZONES; zone++)
+        if (activeZones & (1 << zone))
+            count++;
+    if (count > 0)
+    {
+        share = (now - shareTick) / count;
+        for (zone = 0; zone < NUM_ZONES; zone++)
+            if (activeZones & (1 << zone))
+                pulseShareMs[zone] += share;
+    }
+    shareTick = now;
+}
+
+// Pulse length the spare volume allows, 0 if not even a minimum pulse
+// A pump flow of 0 (run duty at the stall duty) can not be checked against
+// the reserve, so nothing is started until the flow is set again
+uint32_t fitPulse(uint32_t ms, float flow, uint32_t spareMl, uint32_t now)
+{
+    uint32_t committed = getCommittedMl(now);
+    float allowed;
+    if (flow <= 0)
+        return 0;
+    if (spareMl <= committed)
+        return 0;
+    allowed = (spareMl - committed) * 1000 / flow;
+    if (allowed < ms)
+        ms = allowed;
+    if (ms < MIN_PULSE_MS)
+        return 0;
+    return ms;
+}
+
+// Takes the zone out of the queue and commits its water
+void startPulse(uint8_t zone, uint32_t ms, float flow, uint32_t now)
+{
+    if (zone >= NUM_ZONES)
+        return;
+    if ((waitingZones & (1 << zone)) && now - requestTick[zone] > longestWait)
+        longestWait = now - requestTick[zone];
+    waitingZones &= ~(1 << zone);
+    updateShares(now);
+    activeZones |= 1 << zone;
+    pulseShareMs[zone] = 0;
+    pulseStart[zone] = now;
+    pulseLength[zone] = ms;
+    pulseFlow[zone] = flow;
+}
+
+// Returns the full-flow pump time the zone got, in ms
+uint32_t endPulse(uint8_t zone, uint32_t now)
+{
+    if (zone >= NUM_ZONES || !(activeZones & (1 << zone)))
+        return 0;
+    updateShares(now);
+    activeZones &= ~(1 << zone);
+    return pulseShareMs[zone];
+}
+
+// Longest any request has waited for a slot, in ms
+uint32_t getLongestWait()
+{
+    return longestWait;
+}
@@ -0,0 +1,51 @@
+// Watering Dispatch Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// None
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef DISPATCH_H_
+#define DISPATCH_H_
+
+// Zone valves open at once, override with -DMAX_ACTIVE_ZONES=k.  The
+// valves share the one pump, so more than one only spreads its flow
+#ifndef MAX_ACTIVE_ZONES
+#define MAX_ACTIVE_ZONES 1
+#endif
+#if MAX_ACTIVE_ZONES < 1 || MAX_ACTIVE_ZONES > NUM_ZONES
+#error MAX_ACTIVE_ZONES must be 1 to NUM_ZONES
+#endif
+
+// A request waiting this long goes ahead of every newer one: one pulse
+// for each zone spread over the valve slots
+#define MAX_WAIT_MS (((NUM_ZONES + MAX_ACTIVE_ZONES - 1) / MAX_ACTIVE_ZONES) * MAX_PULSE_MS)
+
+#define DEADLINE_STEP_MINUTES 10            // deadlines this close are ranked by deficit
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void requestWatering(uint8_t zone, float deficit, uint16_t minutesLeft, uint32_t now);
+void cancelWatering(uint8_t zone);
+bool isWateringRequested(uint8_t zone);
+uint8_t takeExpiredRequests(uint32_t now);
+uint8_t getNextRequest(uint32_t now);
+uint32_t fitPulse(uint32_t ms, float flow, uint32_t spareMl, uint32_t now);
+void startPulse(uint8_t zone, uint32_t ms, float flow, uint32_t now);
+uint32_t endPulse(uint8_t zone, uint32_t now);
+uint32_t getCommittedMl(uint32_t now);
+uint32_t getLongestWait();
+
+#endif
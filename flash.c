@@ -0,0 +1,83 @@
+// Flash Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// Internal flash, 1 KiB erase pages
+// User data region at the top of flash (reserved in tm4c123gh6pm.cmd)
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "flash.h"
+
+#define FLASH_ALT_WRKEY         0x71D50000
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Only the reserved user region may be modified so a bad address can never
+// take out the program image
+static bool isUserAddress(uint32_t address)
+{
+    return (address >= FLASH_USER_BASE) && (address < FLASH_USER_BASE + FLASH_USER_SIZE);
+}
+
+// The write key depends on the KEY bit in BOOTCFG
+static uint32_t getFlashKey()
+{
+    if (FLASH_BOOTCFG_R & FLASH_BOOTCFG_KEY)
+        return FLASH_FMC_WRKEY;
+    return FLASH_ALT_WRKEY;
+}
+
+// Erase the 1 KiB page containing address
+bool eraseFlashPage(uint32_t address)
+{
+    if (!isUserAddress(address))
+        return false;
+    FLASH_FMA_R = address & ~(FLASH_PAGE_SIZE - 1);
+    FLASH_FMC_R = getFlashKey() | FLASH_FMC_ERASE;
+    while (FLASH_FMC_R & FLASH_FMC_ERASE);           // wait for erase to complete
+    return true;
+}
+
+// Program one word (page must already be erased)
+bool writeFlashWord(uint32_t address, uint32_t data)
+{
+    if (!isUserAddress(address) || (address & 3))
+        return false;
+    FLASH_FMA_R = address;
+    FLASH_FMD_R = data;
+    FLASH_FMC_R = getFlashKey() | FLASH_FMC_WRITE;
+    while (FLASH_FMC_R & FLASH_FMC_WRITE);           // wait for write to complete
+    return true;
+}
+
+// Erase and program consecutive words starting on a page boundary
+bool writeFlashBlock(uint32_t address, const uint32_t* data, uint32_t count)
+{
+    uint32_t i;
+    if (address & (FLASH_PAGE_SIZE - 1))
+        return false;
+    for (i = 0; i < count; i++)
+    {
+        if (((address + i*4) & (FLASH_PAGE_SIZE - 1)) == 0)
+            if (!eraseFlashPage(address + i*4))
+                return false;
+        if (!writeFlashWord(address + i*4, data[i]))
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,34 @@
+// Flash Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// Internal flash, 1 KiB erase pages
+// User data region at the top of flash (reserved in tm4c123gh6pm.cmd)
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef FLASH_H_
+#define FLASH_H_
+
+#define FLASH_PAGE_SIZE         1024
+#define FLASH_USER_BASE         0x0003F000
+#define FLASH_USER_SIZE         0x00001000
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+bool eraseFlashPage(uint32_t address);
+bool writeFlashWord(uint32_t address, uint32_t data);
+bool writeFlashBlock(uint32_t address, const uint32_t* data, uint32_t count);
+
+#endif
@@ -0,0 +1,107 @@
+// Hibernation Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// Hibernation module with 32.768 kHz crystal and VBAT backup
+// RTC match 0 used as the wake source
+
+// Before hibernating, the caller's state words are copied into the
+// battery-backed HIB_DATA registers and tagged with a magic word.  The
+// core is then powered down until the RTC reaches the match value.  A
+// wake from hibernation looks like a reset, so initHibernate reports it
+// and loadHibernateState hands the saved words back exactly once.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "hibernate.h"
+
+#define HIB_STATE_MAGIC 0x48494253
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+bool hibernateWake = false;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Hibernation registers are written through a slow clock domain
+void waitHibernateWrite()
+{
+    while (!(HIB_CTL_R & HIB_CTL_WRC));
+}
+
+// Start the RTC on a cold boot, leave it alone after a wake
+// Returns true when the processor has just left hibernation
+bool initHibernate()
+{
+    if ((HIB_CTL_R & (HIB_CTL_CLK32EN | HIB_CTL_RTCEN)) == (HIB_CTL_CLK32EN | HIB_CTL_RTCEN))
+    {
+        hibernateWake = (HIB_RIS_R & (HIB_RIS_RTCALT0 | HIB_RIS_EXTW)) != 0;
+        waitHibernateWrite();
+        HIB_IC_R = HIB_IC_RTCALT0 | HIB_IC_EXTW;
+        return hibernateWake;
+    }
+    HIB_IM_R |= HIB_IM_WC;
+    HIB_CTL_R |= HIB_CTL_CLK32EN;
+    while (HIB_MIS_R == 0x0);
+    HIB_CTL_R |= HIB_CTL_RTCEN;
+    hibernateWake = false;
+    return false;
+}
+
+uint32_t readHibernateData(uint8_t index)
+{
+    return (&HIB_DATA_R)[index];
+}
+
+void writeHibernateData(uint8_t index, uint32_t value)
+{
+    waitHibernateWrite();
+    (&HIB_DATA_R)[index] = value;
+}
+
+// Returns the state saved before hibernation, only after a hibernation wake
+bool loadHibernateState(uint32_t state[])
+{
+    uint8_t i;
+    if (!hibernateWake || readHibernateData(HIB_DATA_MAGIC) != HIB_STATE_MAGIC)
+        return false;
+    for (i = 0; i < HIB_DATA_STATE_WORDS; i++)
+        state[i] = readHibernateData(HIB_DATA_STATE + i);
+    writeHibernateData(HIB_DATA_MAGIC, 0);
+    hibernateWake = false;
+    return true;
+}
+
+// Save state and power down until the RTC reaches rtcSeconds, does not return
+void hibernateUntil(uint32_t rtcSeconds, const uint32_t state[])
+{
+    uint8_t i;
+    for (i = 0; i < HIB_DATA_STATE_WORDS; i++)
+        writeHibernateData(HIB_DATA_STATE + i, state[i]);
+    writeHibernateData(HIB_DATA_MAGIC, HIB_STATE_MAGIC);
+    waitHibernateWrite();
+    HIB_RTCM0_R = rtcSeconds;
+    waitHibernateWrite();
+    HIB_IC_R = HIB_IC_RTCALT0 | HIB_IC_EXTW;
+    waitHibernateWrite();
+    HIB_CTL_R |= HIB_CTL_RTCWEN | HIB_CTL_PINWEN;
+    waitHibernateWrite();
+    HIB_CTL_R |= HIB_CTL_HIBREQ;
+    while (true);
+}
@@ -0,0 +1,41 @@
+// Hibernation Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// Hibernation module with 32.768 kHz crystal and VBAT backup
+// RTC match 0 used as the wake source
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef HIBERNATE_H_
+#define HIBERNATE_H_
+
+// Battery-backed HIB_DATA word assignments
+#define HIB_DATA_WORDS 16
+#define HIB_DATA_MAGIC 0
+#define HIB_DATA_STATE 1
+#define HIB_DATA_STATE_WORDS 12
+#define HIB_DATA_SYNC_TIME 13
+#define HIB_DATA_SYNC_MAGIC 14
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+bool initHibernate();
+void waitHibernateWrite();
+uint32_t readHibernateData(uint8_t index);
+void writeHibernateData(uint8_t index, uint32_t value);
+bool loadHibernateState(uint32_t state[]);
+void hibernateUntil(uint32_t rtcSeconds, const uint32_t state[]);
+
+#endif
@@ -0,0 +1,130 @@
+// Console Throughput Benchmark
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: Linux host
+// Target uC:       -
+// System Clock:    -
+
+// Hardware configuration:
+// None
+
+// Runs representative command mixes through the host console path and
+// reports lines per second and the worst case cycles per line for each.
+// Cycles come from the time stamp counter on x86 and from the monotonic
+// clock in ns elsewhere, so the worst case is a host figure: compare runs
+// with each other, not with the 40 MHz target.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
+#include "../console.h"
+#include "../uart0.h"
+#include "uart0_host.h"
+#include "console_host.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define readCycles() __rdtsc()
+#define CYCLE_UNIT "cycles"
+#else
+#define readCycles() readNs()
+#define CYCLE_UNIT "ns"
+#endif
+
+#define BENCH_PASSES 20000
+
+typedef struct _MIX
+{
+    const char* name;
+    const char* const* lines;
+} MIX;
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+// What an operator types
+const char* const interactiveLines[] =
+{
+    "status", "pump ON", "pump OFF", "time 14 30", "volume 1500", "date",
+    "zones", "zone 2 target 45", "alerts", "ack", "verbose normal", "tasks",
+    NULL
+};
+
+// What a boot script holds
+const char* const scriptLines[] =
+{
+    "water 6 0 8 0;window list", "level 30;target 40", "zone 0 level 30;zone 1 target 45;zone 2 windows 3",
+    "deepsleep 1;verbose quiet", "alert 1;power", "sync 1700000000",
+    NULL
+};
+
+// Typos, overlong lines and noise
+const char* const badLines[] =
+{
+    "", ";;;;", "statu", "pump", "water 25 00 17", "zone", "zone 0 on", "verbose 2",
+    "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
+    "1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20", "-- ,, :: !! ??", "99999999999999999999",
+    NULL
+};
+
+const MIX mixes[] =
+{
+    {"interactive", interactiveLines},
+    {"script", scriptLines},
+    {"malformed", badLines},
+};
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static uint64_t readNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static void runMix(const MIX* mix)
+{
+    const char* const* line;
+    uint64_t start, end, cycles, worst = 0;
+    uint32_t lines = 0, valid = 0, pass;
+    double seconds;
+    start = readNs();
+    for (pass = 0; pass < BENCH_PASSES; pass++)
+    {
+        for (line = mix->lines; *line != NULL; line++)
+        {
+            clearUart0Output();
+            cycles = readCycles();
+            valid += executeHostLine(*line);
+            cycles = readCycles() - cycles;
+            if (cycles > worst)
+                worst = cycles;
+            lines++;
+        }
+    }
+    end = readNs();
+    seconds = (end - start) / 1e9;
+    printf("%-12s %9u lines %12.0f lines/s  worst %8llu %s/line  %u valid commands\n",
+           mix->name, lines, lines / seconds, (unsigned long long)worst, CYCLE_UNIT, valid);
+}
+
+int main()
+{
+    uint8_t i;
+    initUart0();
+    for (i = 0; i < sizeof(mixes) / sizeof(mixes[0]); i++)
+        runMix(&mixes[i]);
+    return 0;
+}
@@ -0,0 +1,168 @@
+// Console Fuzz Target
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: Linux host
+// Target uC:       -
+// System Clock:    -
+
+// Hardware configuration:
+// None
+
+// libFuzzer entry point for the console parser.  Each input is typed at
+// the console through the UART0 stub and executed line by line, then put
+// straight into a USER_DATA buffer (control characters and all) and parsed
+// again, checking that every field stays inside the buffer.
+//
+// Built with -DFUZZ_STANDALONE there is a main instead, for compilers
+// without libFuzzer: it replays the files named on the command line, or
+// runs FUZZ_RUNS pseudo-random inputs when none are given.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../console.h"
+#include "../command.h"
+#include "../uart0.h"
+#include "uart0_host.h"
+#include "console_host.h"
+
+#define FUZZ_RUNS 1000000
+#define FUZZ_MAX_SIZE 512
+
+#define check(x) do { if (!(x)) { fprintf(stderr, "check failed: %s\n", #x); abort(); } } while (0)
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static void checkFields(USER_DATA* data)
+{
+    uint8_t field;
+    check(data->fieldCount < MAX_FIELDS);
+    for (field = 0; field <= data->fieldCount; field++)
+    {
+        if (data->fieldType[field] != 'a' && data->fieldType[field] != 'n')
+            continue;
+        check(data->fieldPosition[field] < MAX_CHARS);
+        check(strlen(getFieldString(data, field)) <= MAX_CHARS);
+        getFieldInteger(data, field);
+    }
+    check(getFieldString(data, MAX_FIELDS)[0] == '\0');
+    check(getFieldInteger(data, 0xFF) == 0);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    USER_DATA user;
+    uint8_t command;
+    size_t length;
+
+    // As typed at the console
+    initUart0();
+    setUart0Input(data, size);
+    while (kbhitUart0())
+    {
+        getsUart0(&user);
+        check(strlen(user.buffer) <= MAX_CHARS);
+        clearUart0Output();
+        executeHostLine(user.buffer);
+    }
+
+    // As one raw command
+    length = size < MAX_CHARS ? size : MAX_CHARS;
+    memcpy(user.buffer, data, length);
+    user.buffer[length] = '\0';
+    parseFields(&user);
+    checkFields(&user);
+    for (command = 0; command < COMMAND_COUNT; command++)
+        isCommand(&user, getCommandName(command), 0);
+    findCommand(&user);
+    return 0;
+}
+
+#ifdef FUZZ_STANDALONE
+static uint32_t seed = 1;
+
+static uint32_t nextRandom()
+{
+    seed = seed * 1664525 + 1013904223;
+    return seed >> 8;
+}
+
+static void runFile(const char* name)
+{
+    static uint8_t data[65536];
+    size_t size;
+    FILE* file = fopen(name, "rb");
+    if (file == NULL)
+    {
+        perror(name);
+        exit(1);
+    }
+    size = fread(data, 1, sizeof(data), file);
+    fclose(file);
+    LLVMFuzzerTestOneInput(data, size);
+}
+
+// Mostly command words, digits and delimiters so inputs reach past the
+// first field, with some arbitrary bytes mixed in
+static void runRandom(uint32_t runs)
+{
+    static const char alphabet[] = "0123456789 ;:-,\r\b\x7f";
+    uint8_t data[FUZZ_MAX_SIZE];
+    const char* word;
+    size_t size, target;
+    uint32_t run;
+    for (run = 0; run < runs; run++)
+    {
+        target = nextRandom() % FUZZ_MAX_SIZE;
+        size = 0;
+        while (size < target)
+        {
+            switch (nextRandom() % 4)
+            {
+            case 0:
+                word = getCommandName(nextRandom() % COMMAND_COUNT);
+                while (*word != '\0' && size < target)
+                    data[size++] = *word++;
+                break;
+            case 1:
+            case 2:
+                data[size++] = alphabet[nextRandom() % (sizeof(alphabet) - 1)];
+                break;
+            default:
+                data[size++] = nextRandom();
+                break;
+            }
+        }
+        LLVMFuzzerTestOneInput(data, size);
+    }
+    printf("%u random inputs, no failures\n", runs);
+}
+
+int main(int argc, char* argv[])
+{
+    int i;
+    if (argc > 1)
+    {
+        for (i = 1; i < argc; i++)
+            runFile(argv[i]);
+        printf("%d files, no failures\n", argc - 1);
+    }
+    else
+        runRandom(FUZZ_RUNS);
+    return 0;
+}
+#endif
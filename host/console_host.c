@@ -0,0 +1,87 @@
+// Console Host Driver
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: Linux host
+// Target uC:       -
+// System Clock:    -
+
+// Hardware configuration:
+// None, serial I/O goes through the UART0 host stub
+
+// The console path of the firmware without the hardware behind it.  Lines
+// are read with getsUart0 and split with splitLine from the console
+// library, and each command is looked up with findCommand in the firmware's
+// command table, so a command is valid here when its arguments fit the
+// same forms executeCommand accepts.  Range checks such as zone numbers
+// stay in executeCommand and are not repeated.  A valid command reads all
+// of its fields with getFieldString or getFieldInteger and prints a short
+// reply instead of acting on them.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../console.h"
+#include "../command.h"
+#include "../uart0.h"
+#include "console_host.h"
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static void putUint(uint32_t value)
+{
+    char string[11];
+    uint8_t i = 10;
+    string[i] = '\0';
+    do
+    {
+        string[--i] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+    putsUart0(&string[i]);
+}
+
+// Returns the command number, NO_COMMAND if the command is invalid
+static uint8_t executeHostCommand(USER_DATA* data)
+{
+    uint8_t command, field;
+    command = findCommand(data);
+    if (command == NO_COMMAND)
+    {
+        putsUart0("Invalid command\n\r");
+        return command;
+    }
+    putsUart0(getFieldString(data, 0));
+    for (field = 1; field <= data->fieldCount && field < MAX_FIELDS; field++)
+    {
+        putcUart0(' ');
+        if (data->fieldType[field] == 'n')
+            putUint(getFieldInteger(data, field));
+        else
+            putsUart0(getFieldString(data, field));
+    }
+    putsUart0("\n\r");
+    return command;
+}
+
+// Splits a line like executeLine and returns how many of its commands were
+// valid
+uint8_t executeHostLine(const char* line)
+{
+    USER_DATA data;
+    uint8_t valid=0;
+    do
+    {
+        line=splitLine(line,&data);
+        if(executeHostCommand(&data) != NO_COMMAND)
+            valid++;
+    } while(*line!='\0');
+    return valid;
+}
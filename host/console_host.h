@@ -0,0 +1,27 @@
+// Console Host Driver
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: Linux host
+// Target uC:       -
+// System Clock:    -
+
+// Hardware configuration:
+// None, serial I/O goes through the UART0 host stub
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef CONSOLE_HOST_H_
+#define CONSOLE_HOST_H_
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+uint8_t executeHostLine(const char* line);
+
+#endif
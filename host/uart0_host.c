@@ -0,0 +1,109 @@
+// UART0 Host Stub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: Linux host
+// Target uC:       -
+// System Clock:    -
+
+// Hardware configuration:
+// None, receive data comes from a memory buffer and transmitted data is
+// counted (and optionally kept) instead of sent
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../uart0.h"
+#include "uart0_host.h"
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+const uint8_t* rxData = NULL;
+size_t rxSize = 0;
+size_t rxIndex = 0;
+uint32_t txCount = 0;
+char txLast[TX_KEEP+1];
+uint16_t txIndex = 0;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initUart0()
+{
+    rxData = NULL;
+    rxSize = rxIndex = 0;
+    txCount = 0;
+    txIndex = 0;
+    txLast[0] = '\0';
+}
+
+void setUart0BaudRate(uint32_t baudRate, uint32_t fcyc)
+{
+}
+
+// Keeps the latest reply so a caller can look at it
+void putcUart0(char c)
+{
+    txCount++;
+    if (txIndex < TX_KEEP)
+    {
+        txLast[txIndex++] = c;
+        txLast[txIndex] = '\0';
+    }
+}
+
+void putsUart0(char* str)
+{
+    while (*str != '\0')
+        putcUart0(*str++);
+}
+
+// Returns a carriage return once the input is used up so a reader never
+// waits forever
+char getcUart0()
+{
+    if (rxIndex >= rxSize)
+        return 13;
+    return rxData[rxIndex++];
+}
+
+bool kbhitUart0()
+{
+    return rxIndex < rxSize;
+}
+
+void uart0Isr()
+{
+}
+
+void setUart0Input(const uint8_t* data, size_t size)
+{
+    rxData = data;
+    rxSize = size;
+    rxIndex = 0;
+}
+
+void clearUart0Output()
+{
+    txIndex = 0;
+    txLast[0] = '\0';
+}
+
+uint32_t getUart0TxCount()
+{
+    return txCount;
+}
+
+const char* getUart0Output()
+{
+    return txLast;
+}
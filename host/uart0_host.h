@@ -0,0 +1,32 @@
+// UART0 Host Stub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: Linux host
+// Target uC:       -
+// System Clock:    -
+
+// Hardware configuration:
+// None
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef UART0_HOST_H_
+#define UART0_HOST_H_
+
+#define TX_KEEP 255                             // characters kept since the last clear
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void setUart0Input(const uint8_t* data, size_t size);
+void clearUart0Output();
+uint32_t getUart0TxCount();
+const char* getUart0Output();
+
+#endif
@@ -0,0 +1,633 @@
+// Kernel Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    Read from the clock library
+
+// Hardware configuration:
+// SysTick provides the 1 ms kernel time base
+// PendSV switches threads
+// Timer3A wakes the core from WFI when the kernel is idle
+
+// Each task is a thread with its own static stack and a priority, 0 the
+// highest.  The thread calls its task function over and over: as before
+// a task that calls sleepTask(ms) is not called again until the delay
+// expires, and one that calls suspendTask() waits for resumeTask().  Both
+// take effect when the task function returns, so a task that calls them
+// part way through still finishes its update first.  A task may also
+// block part way through on a semaphore or queue.
+//
+// The highest priority ready thread runs.  A thread that becomes ready
+// (tick, ISR, post) preempts a lower priority one at once through PendSV.
+// Threads of equal priority do not preempt each other: each runs its task
+// function to the end and then yields to the next ready one round robin,
+// so tasks at one priority share data as freely as under the old
+// cooperative loop, up to any point where one of them blocks.  A thread
+// preempted part way through its function resumes before its equals.  A
+// thread of lower priority that shares data with them takes a semaphore
+// with their priority as ceiling while it does.
+//
+// PendSV has the lowest exception priority, so a switch never interrupts
+// an ISR.  It saves R4-R11 and EXC_RETURN on the thread stack, plus S16-S31
+// when the thread has used the FPU (EXC_RETURN bit 4 clear).  The FPU's
+// lazy stacking (ASPEN, LSPEN) only stores S0-S15 if the next thread or ISR
+// touches the FPU, so integer-only switches cost no FPU traffic.
+//
+// When no task is ready the idle thread stops SysTick, arms Timer3A for the
+// earliest wake time and executes WFI.  Any enabled interrupt (UART RX in
+// particular) ends the sleep early, and the elapsed time is added back to
+// the tick count from the timestamp clock.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "kernel.h"
+#include "clock.h"
+
+#define MAX_IDLE_MS 100000
+#define IDLE_TASK MAX_TASKS
+#define IDLE_STACK_WORDS 128
+#define NO_TASK 0xFF
+#define STACK_FILL 0xA5A5A5A5
+#define INITIAL_XPSR 0x01000000                     // Thumb state
+#define EXC_RETURN_THREAD_PSP 0xFFFFFFFD            // thread mode, PSP, no FPU frame
+#define PENDSV_PRIORITY 7                           // lowest
+#define MIN_RELOAD_CYCLES 64                        // shortest SysTick period set after a sleep
+
+typedef struct _TASK
+{
+    _fn fn;
+    const char* name;
+    uint32_t* sp;
+    uint32_t* stack;
+    uint32_t stackWords;
+    uint8_t basePriority;
+    uint8_t priority;                               // raised while holding a lock
+    uint32_t wakeTick;
+    uint32_t nextWakeTick;                          // set by sleepTask, applied at the return
+    bool sleepPending;
+    bool suspended;
+    bool suspendPending;
+    bool yielded;
+    bool preempted;
+    void* blockedOn;                                // semaphore or queue
+    uint32_t runs;
+    uint32_t maxCycles;
+} TASK;
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+volatile uint32_t ticks = 0;
+uint32_t systickReload;
+TASK tasks[MAX_TASKS + 1];                          // the idle thread is last
+uint8_t taskCount = 0;
+volatile uint8_t taskCurrent = IDLE_TASK;
+bool kernelRunning = false;
+uint32_t idleStack[IDLE_STACK_WORDS];
+KERNEL_STATS kernelStats;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+uint32_t* switchThread(uint32_t* sp);
+void startThreads(uint32_t* sp, _fn fn);
+
+// Saves the thread being left, lets switchThread pick the next one and
+// restores it.  S16-S31 only move for threads with an FPU frame
+__asm("    .thumb\n"
+      "    .text\n"
+      "    .align 2\n"
+      "    .global pendSvIsr\n"
+      "    .thumbfunc pendSvIsr\n"
+      "pendSvIsr:\n"
+      "    MRS     R0, PSP\n"
+      "    TST     LR, #0x10\n"
+      "    IT      EQ\n"
+      "    VSTMDBEQ R0!, {S16-S31}\n"
+      "    STMDB   R0!, {R4-R11, LR}\n"
+      "    BL      switchThread\n"
+      "    LDMIA   R0!, {R4-R11, LR}\n"
+      "    TST     LR, #0x10\n"
+      "    IT      EQ\n"
+      "    VLDMIAEQ R0!, {S16-S31}\n"
+      "    MSR     PSP, R0\n"
+      "    BX      LR\n");
+
+// Nestable interrupt masking, returns the previous PRIMASK
+__asm("    .global enterCritical\n"
+      "    .thumbfunc enterCritical\n"
+      "enterCritical:\n"
+      "    MRS     R0, PRIMASK\n"
+      "    CPSID   I\n"
+      "    BX      LR\n"
+      "    .global leaveCritical\n"
+      "    .thumbfunc leaveCritical\n"
+      "leaveCritical:\n"
+      "    MSR     PRIMASK, R0\n"
+      "    BX      LR\n");
+
+// Moves thread mode onto the process stack at sp and jumps to fn
+__asm("    .global startThreads\n"
+      "    .thumbfunc startThreads\n"
+      "startThreads:\n"
+      "    MSR     PSP, R0\n"
+      "    MOVS    R0, #2\n"
+      "    MSR     CONTROL, R0\n"
+      "    ISB\n"
+      "    BX      R1\n");
+
+static bool isTaskReady(uint8_t task)
+{
+    return !tasks[task].suspended && tasks[task].blockedOn == 0 && (int32_t)(ticks - tasks[task].wakeTick) >= 0;
+}
+
+// Priority of the running thread, the idle thread is below every task
+static uint8_t getCurrentPriority()
+{
+    if (taskCurrent == IDLE_TASK)
+        return LOWEST_PRIORITY + 1;
+    return tasks[taskCurrent].priority;
+}
+
+static bool isPreemptNeeded()
+{
+    uint8_t task;
+    uint8_t priority = getCurrentPriority();
+    for (task = 0; task < taskCount; task++)
+        if (tasks[task].priority < priority && isTaskReady(task))
+            return true;
+    return false;
+}
+
+// Pends PendSV, which runs as soon as no ISR is active and interrupts are on
+static void requestSwitch()
+{
+    if (!kernelRunning)
+        return;
+    NVIC_INT_CTRL_R = NVIC_INT_CTRL_PEND_SV;
+    __asm("    ISB");
+}
+
+// Preempts the running thread if a higher priority one has become ready
+static void schedule()
+{
+    if (kernelRunning && isPreemptNeeded())
+        requestSwitch();
+}
+
+void systickIsr()
+{
+    ticks++;
+    schedule();
+}
+
+// Only needs to end the WFI, the elapsed time is read by idleKernel
+void idleTimerIsr()
+{
+    TIMER3_ICR_R = TIMER_ICR_TATOCINT;
+}
+
+uint32_t getTicks()
+{
+    return ticks;
+}
+
+// Start the 1 kHz SysTick time base and the idle wakeup timer
+void initKernel()
+{
+    systickReload = getSysClockHz() / KERNEL_TICK_HZ;
+    NVIC_ST_CTRL_R = 0;
+    NVIC_ST_RELOAD_R = systickReload - 1;
+    NVIC_ST_CURRENT_R = 0;
+    NVIC_ST_CTRL_R = NVIC_ST_CTRL_CLK_SRC | NVIC_ST_CTRL_INTEN | NVIC_ST_CTRL_ENABLE;
+
+    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R3;
+    _delay_cycles(3);
+    TIMER3_CTL_R &= ~TIMER_CTL_TAEN;
+    TIMER3_CFG_R = TIMER_CFG_32_BIT_TIMER;
+    TIMER3_TAMR_R = TIMER_TAMR_TAMR_1_SHOT;
+    TIMER3_IMR_R = TIMER_IMR_TATOIM;
+    NVIC_EN1_R |= 1 << (INT_TIMER3A-16-32);
+
+    NVIC_SYS_PRI3_R = (NVIC_SYS_PRI3_R & ~NVIC_SYS_PRI3_PENDSV_M) | (PENDSV_PRIORITY << NVIC_SYS_PRI3_PENDSV_S);
+    NVIC_FPCC_R |= NVIC_FPCC_ASPEN | NVIC_FPCC_LSPEN;   // reset values, relied on by pendSvIsr
+}
+
+
+// Calls the task function for as long as the kernel runs.  The cycle count
+// of a call includes any time the thread spent preempted.  A sleep or
+// suspend asked for during the call only makes the thread not ready here,
+// so until then it keeps its place against its equals
+static void runTask(uint32_t task)
+{
+    uint32_t start, cycles, mask;
+    while (true)
+    {
+        start = getCycles();
+        tasks[task].fn();
+        cycles = getCycles() - start;
+        tasks[task].runs++;
+        if (cycles > tasks[task].maxCycles)
+            tasks[task].maxCycles = cycles;
+        mask = enterCritical();
+        if (tasks[task].sleepPending)
+            tasks[task].wakeTick = tasks[task].nextWakeTick;
+        if (tasks[task].suspendPending)
+            tasks[task].suspended = true;
+        tasks[task].sleepPending = false;
+        tasks[task].suspendPending = false;
+        leaveCritical(mask);
+        yieldTask();
+    }
+}
+
+// Builds the frame pendSvIsr restores on the first switch to the thread:
+// R4-R11 and EXC_RETURN, then the exception frame entering runTask(task)
+static void initStack(uint8_t task)
+{
+    uint32_t* sp = (uint32_t*)((uint32_t)&tasks[task].stack[tasks[task].stackWords] & ~7);
+    uint8_t i;
+    for (i = 0; i < 8; i++)
+        *--sp = 0;                                  // PC, LR, R12 and R3-R0 filled in below
+    sp[7] = INITIAL_XPSR;
+    sp[6] = (uint32_t)runTask & ~1;
+    sp[0] = task;
+    *--sp = EXC_RETURN_THREAD_PSP;
+    for (i = 0; i < 8; i++)
+        *--sp = 0;
+    tasks[task].sp = sp;
+}
+
+// Tasks are created before startKernel, each on a stack the caller owns
+bool createTask(_fn fn, const char name[], uint8_t priority, uint32_t stack[], uint32_t stackWords)
+{
+    uint32_t i;
+    if (taskCount == MAX_TASKS || kernelRunning || priority > LOWEST_PRIORITY || stackWords < MIN_STACK_WORDS)
+        return false;
+    for (i = 0; i < stackWords; i++)
+        stack[i] = STACK_FILL;
+    tasks[taskCount].fn = fn;
+    tasks[taskCount].name = name;
+    tasks[taskCount].stack = stack;
+    tasks[taskCount].stackWords = stackWords;
+    tasks[taskCount].basePriority = priority;
+    tasks[taskCount].priority = priority;
+    tasks[taskCount].wakeTick = ticks;
+    tasks[taskCount].sleepPending = false;
+    tasks[taskCount].suspended = false;
+    tasks[taskCount].suspendPending = false;
+    tasks[taskCount].yielded = false;
+    tasks[taskCount].preempted = false;
+    tasks[taskCount].blockedOn = 0;
+    tasks[taskCount].runs = 0;
+    tasks[taskCount].maxCycles = 0;
+    initStack(taskCount);
+    taskCount++;
+    return true;
+}
+
+// Called from a task: do not run it again for ms milliseconds, counted
+// from now
+void sleepTask(uint32_t ms)
+{
+    tasks[taskCurrent].nextWakeTick = ticks + ms;
+    tasks[taskCurrent].sleepPending = true;
+}
+
+// Called from a task: do not run it again until resumeTask
+void suspendTask()
+{
+    tasks[taskCurrent].suspendPending = true;
+}
+
+// Makes a suspended task ready, a sleeping task is left alone
+void resumeTask(_fn fn)
+{
+    uint8_t task;
+    uint32_t mask = enterCritical();
+    for (task = 0; task < taskCount; task++)
+    {
+        if (tasks[task].fn == fn)
+            tasks[task].suspendPending = false;
+        if (tasks[task].fn == fn && tasks[task].suspended)
+        {
+            tasks[task].wakeTick = ticks;
+            tasks[task].suspended = false;
+        }
+    }
+    leaveCritical(mask);
+    schedule();
+}
+
+// Lets the other ready threads of the same priority run first
+void yieldTask()
+{
+    tasks[taskCurrent].yielded = true;
+    requestSwitch();
+}
+
+// Order of choice: priority, then a thread that was preempted part way
+// through its task function, then round robin
+static uint8_t getRank(uint8_t task)
+{
+    return tasks[task].priority*2 + (tasks[task].preempted ? 0 : 1);
+}
+
+// Called from pendSvIsr with the stack pointer of the thread being left,
+// returns the stack pointer of the thread to run.  The running thread
+// keeps the CPU against equals unless it yielded, otherwise the search
+// starts after it so equal priorities take turns
+uint32_t* switchThread(uint32_t* sp)
+{
+    uint8_t i, task, ready = 0;
+    uint8_t next = IDLE_TASK;
+    uint8_t best = 2*LOWEST_PRIORITY + 2;
+    uint8_t start = taskCurrent == IDLE_TASK ? 0 : taskCurrent + 1;
+    bool running = taskCurrent != IDLE_TASK && isTaskReady(taskCurrent) && !tasks[taskCurrent].yielded;
+    tasks[taskCurrent].sp = sp;
+    if (running)
+    {
+        next = taskCurrent;
+        best = tasks[taskCurrent].priority*2;
+    }
+    for (i = 0; i < taskCount; i++)
+    {
+        task = (start + i) % taskCount;
+        if (isTaskReady(task))
+        {
+            ready++;
+            if (getRank(task) < best)
+            {
+                best = getRank(task);
+                next = task;
+            }
+        }
+    }
+    if (next != taskCurrent)
+    {
+        kernelStats.switches++;
+        if (running)
+        {
+            kernelStats.preemptions++;
+            tasks[taskCurrent].preempted = true;    // resumes before its equals
+        }
+    }
+    if (ready > kernelStats.maxReady)
+        kernelStats.maxReady = ready;
+    tasks[taskCurrent].yielded = false;
+    tasks[next].preempted = false;
+    taskCurrent = next;
+    return tasks[next].sp;
+}
+
+// Milliseconds until the earliest task wake time
+static uint32_t getIdleTime()
+{
+    uint8_t task;
+    uint32_t ms = MAX_IDLE_MS;
+    int32_t delta;
+    for (task = 0; task < taskCount; task++)
+    {
+        if (!tasks[task].suspended && tasks[task].blockedOn == 0)
+        {
+            delta = (int32_t)(tasks[task].wakeTick - ticks);
+            if (delta <= 0)
+                return 0;
+            if ((uint32_t)delta < ms)
+                ms = delta;
+        }
+    }
+    return ms;
+}
+
+// Sleep until the next deadline or any interrupt
+static void idleKernel()
+{
+    uint32_t ms, partial, elapsed, remainder;
+    uint64_t start;
+    __asm("    CPSID I");                               // an ISR can not slip in between the check and WFI
+    ms = getIdleTime();
+    if (ms > 0xFFFFFFFF / systickReload - 1)
+        ms = 0xFFFFFFFF / systickReload - 1;               // must fit in the 32-bit timer
+    if (ms == 0)
+    {
+        __asm("    CPSIE I");
+        return;
+    }
+    kernelStats.idleEntries++;
+    if (ms == 1)
+    {
+        __asm("    WFI");                               // next SysTick ends the sleep
+        kernelStats.sleepTicks++;
+    }
+    else
+    {
+        NVIC_ST_CTRL_R = 0;
+        partial = systickReload - 1 - NVIC_ST_CURRENT_R;  // part of the current tick already gone
+        if (NVIC_INT_CTRL_R & NVIC_INT_CTRL_PENDSTSET)
+        {
+            NVIC_INT_CTRL_R = NVIC_INT_CTRL_PENDSTCLR;  // counted here instead of by systickIsr
+            partial += systickReload;
+        }
+        start = getTimestamp();
+        TIMER3_TAILR_R = ms*systickReload - partial;  // ms >= 2, so this is never negative
+        TIMER3_CTL_R |= TIMER_CTL_TAEN;
+        __asm("    WFI");
+        TIMER3_CTL_R &= ~TIMER_CTL_TAEN;
+        elapsed = partial + (uint32_t)(getTimestamp() - start);
+        remainder = elapsed % systickReload;
+        if (systickReload - remainder < MIN_RELOAD_CYCLES)
+        {
+            elapsed += systickReload - remainder;   // too close to the end of the tick to time it
+            remainder = 0;
+        }
+        ticks += elapsed / systickReload;
+        kernelStats.sleepTicks += elapsed / systickReload;
+
+        // The first tick after the sleep is shortened by the part already
+        // spent, then the normal reload takes over at the next wrap
+        NVIC_ST_RELOAD_R = systickReload - 1 - remainder;
+        NVIC_ST_CURRENT_R = 0;
+        NVIC_ST_CTRL_R = NVIC_ST_CTRL_CLK_SRC | NVIC_ST_CTRL_INTEN | NVIC_ST_CTRL_ENABLE;
+        while (NVIC_ST_CURRENT_R == 0);
+        NVIC_ST_RELOAD_R = systickReload - 1;
+    }
+    kernelStats.wakes++;
+    __asm("    CPSIE I");
+}
+
+// Runs whenever no task is ready
+static void idleThread()
+{
+    while (true)
+    {
+        if (getIdleTime() == 0)
+            requestSwitch();
+        else
+            idleKernel();
+    }
+}
+
+// Switches main onto the idle thread, never returns
+void startKernel()
+{
+    tasks[IDLE_TASK].name = "idle";
+    tasks[IDLE_TASK].priority = LOWEST_PRIORITY + 1;
+    taskCurrent = IDLE_TASK;
+    kernelRunning = true;
+    startThreads(&idleStack[IDLE_STACK_WORDS], idleThread);
+}
+
+// A ceiling semaphore (lock) must be posted by the task that took it
+void initSemaphore(SEMAPHORE* semaphore, uint16_t count, uint8_t ceiling)
+{
+    semaphore->count = count;
+    semaphore->ceiling = ceiling;
+}
+
+// Highest priority task blocked on the semaphore or queue, if any
+static uint8_t findWaiter(void* object)
+{
+    uint8_t task, waiter = NO_TASK;
+    for (task = 0; task < taskCount; task++)
+        if (tasks[task].blockedOn == object && (waiter == NO_TASK || tasks[task].priority < tasks[waiter].priority))
+            waiter = task;
+    return waiter;
+}
+
+// Blocks until the count is above zero.  A post to a blocked task hands
+// the count over directly, so it returns without taking it again
+void waitSemaphore(SEMAPHORE* semaphore)
+{
+    uint32_t mask = enterCritical();
+    if (semaphore->count > 0)
+        semaphore->count--;
+    else
+    {
+        tasks[taskCurrent].blockedOn = semaphore;
+        requestSwitch();                            // taken once interrupts are back on
+    }
+    leaveCritical(mask);
+    if (semaphore->ceiling < tasks[taskCurrent].priority)
+        tasks[taskCurrent].priority = semaphore->ceiling;
+}
+
+// Safe to call from an ISR unless the semaphore has a ceiling
+void postSemaphore(SEMAPHORE* semaphore)
+{
+    uint8_t waiter;
+    uint32_t mask = enterCritical();
+    waiter = findWaiter(semaphore);
+    if (waiter != NO_TASK)
+        tasks[waiter].blockedOn = 0;
+    else
+        semaphore->count++;
+    if (semaphore->ceiling != NO_CEILING)
+        tasks[taskCurrent].priority = tasks[taskCurrent].basePriority;
+    leaveCritical(mask);
+    schedule();
+}
+
+// Queue of capacity items of itemSize bytes in storage the caller owns
+void initQueue(QUEUE* queue, void* items, uint8_t itemSize, uint16_t capacity)
+{
+    queue->items = items;
+    queue->itemSize = itemSize;
+    queue->capacity = capacity;
+    queue->readIndex = 0;
+    queue->writeIndex = 0;
+    queue->count = 0;
+}
+
+// Never blocks, so it is safe to call from an ISR: false if the queue is full
+bool putQueue(QUEUE* queue, const void* item)
+{
+    uint8_t i, waiter;
+    uint32_t mask = enterCritical();
+    if (queue->count == queue->capacity)
+    {
+        leaveCritical(mask);
+        return false;
+    }
+    for (i = 0; i < queue->itemSize; i++)
+        queue->items[queue->writeIndex*queue->itemSize + i] = ((const uint8_t*)item)[i];
+    queue->writeIndex = (queue->writeIndex + 1) % queue->capacity;
+    queue->count++;
+    waiter = findWaiter(queue);
+    if (waiter != NO_TASK)
+        tasks[waiter].blockedOn = 0;
+    leaveCritical(mask);
+    schedule();
+    return true;
+}
+
+// Blocks until an item is available
+void getQueue(QUEUE* queue, void* item)
+{
+    uint8_t i;
+    uint32_t mask;
+    while (true)
+    {
+        mask = enterCritical();
+        if (queue->count > 0)
+            break;
+        tasks[taskCurrent].blockedOn = queue;
+        requestSwitch();
+        leaveCritical(mask);
+    }
+    for (i = 0; i < queue->itemSize; i++)
+        ((uint8_t*)item)[i] = queue->items[queue->readIndex*queue->itemSize + i];
+    queue->readIndex = (queue->readIndex + 1) % queue->capacity;
+    queue->count--;
+    leaveCritical(mask);
+}
+
+uint16_t getQueueCount(QUEUE* queue)
+{
+    return queue->count;
+}
+
+uint8_t getTaskCount()
+{
+    return taskCount;
+}
+
+bool getTaskInfo(uint8_t task, TASK_INFO* info)
+{
+    uint32_t unused = 0;
+    if (task >= taskCount)
+        return false;
+    while (unused < tasks[task].stackWords && tasks[task].stack[unused] == STACK_FILL)
+        unused++;
+    info->name = tasks[task].name;
+    info->priority = tasks[task].basePriority;
+    info->ready = isTaskReady(task);
+    info->suspended = tasks[task].suspended;
+    info->blocked = tasks[task].blockedOn != 0;
+    info->wakeTick = tasks[task].wakeTick;
+    info->runs = tasks[task].runs;
+    info->maxCycles = tasks[task].maxCycles;
+    info->stackSize = tasks[task].stackWords*4;
+    info->stackUsed = (tasks[task].stackWords - unused)*4;
+    return true;
+}
+
+void getKernelStats(KERNEL_STATS* stats)
+{
+    uint32_t runTicks = ticks - kernelStats.sleepTicks;
+    *stats = kernelStats;
+    stats->averageCurrent = 0;
+    if (ticks > 0)
+        stats->averageCurrent = ((uint64_t)runTicks*RUN_CURRENT_UA + (uint64_t)kernelStats.sleepTicks*SLEEP_CURRENT_UA) / ticks;
+}
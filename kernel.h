@@ -0,0 +1,106 @@
+// Kernel Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    Read from the clock library
+
+// Hardware configuration:
+// SysTick provides the 1 ms kernel time base
+// PendSV switches threads
+// Timer3A wakes the core from WFI when the kernel is idle
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef KERNEL_H_
+#define KERNEL_H_
+
+#define MAX_TASKS 8
+#define KERNEL_TICK_HZ 1000
+#define LOWEST_PRIORITY 15                      // 0 is the highest
+#define NO_CEILING 0xFF
+#define MIN_STACK_WORDS 64
+
+// Estimated board supply current used for the average current figure
+#define RUN_CURRENT_UA 32000
+#define SLEEP_CURRENT_UA 11000
+
+typedef void (*_fn)();
+
+typedef struct _TASK_INFO
+{
+    const char* name;
+    uint8_t priority;
+    bool ready;
+    bool suspended;
+    bool blocked;                               // waiting on a semaphore or queue
+    uint32_t wakeTick;
+    uint32_t runs;
+    uint32_t maxCycles;
+    uint32_t stackSize;                         // bytes
+    uint32_t stackUsed;                         // bytes, high-water mark
+} TASK_INFO;
+
+typedef struct _KERNEL_STATS
+{
+    uint32_t switches;
+    uint32_t preemptions;
+    uint32_t idleEntries;
+    uint8_t maxReady;
+    uint32_t wakes;
+    uint32_t sleepTicks;
+    uint32_t averageCurrent;
+} KERNEL_STATS;
+
+// A semaphore with a ceiling is a lock: the holder runs at the ceiling
+// priority until it posts, so no task at or below the ceiling preempts it
+typedef struct _SEMAPHORE
+{
+    volatile uint16_t count;
+    uint8_t ceiling;
+} SEMAPHORE;
+
+typedef struct _QUEUE
+{
+    uint8_t* items;
+    uint8_t itemSize;
+    uint16_t capacity;
+    volatile uint16_t readIndex;
+    volatile uint16_t writeIndex;
+    volatile uint16_t count;
+} QUEUE;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initKernel();
+bool createTask(_fn fn, const char name[], uint8_t priority, uint32_t stack[], uint32_t stackWords);
+void startKernel();
+void sleepTask(uint32_t ms);
+void suspendTask();
+void resumeTask(_fn fn);
+void yieldTask();
+uint32_t getTicks();
+uint32_t enterCritical();
+void leaveCritical(uint32_t mask);
+void initSemaphore(SEMAPHORE* semaphore, uint16_t count, uint8_t ceiling);
+void waitSemaphore(SEMAPHORE* semaphore);
+void postSemaphore(SEMAPHORE* semaphore);
+void initQueue(QUEUE* queue, void* items, uint8_t itemSize, uint16_t capacity);
+bool putQueue(QUEUE* queue, const void* item);
+void getQueue(QUEUE* queue, void* item);
+uint16_t getQueueCount(QUEUE* queue);
+uint8_t getTaskCount();
+bool getTaskInfo(uint8_t task, TASK_INFO* info);
+void getKernelStats(KERNEL_STATS* stats);
+void systickIsr();
+void idleTimerIsr();
+void pendSvIsr();
+
+#endif
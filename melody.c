@@ -0,0 +1,189 @@
+// Melody Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    Read from the clock library
+
+// Hardware configuration:
+// Speaker on PA6 through the PWM library
+// Timer2A steps the notes
+
+// Tunes are queued by playTune and played entirely from timer2Isr, so a
+// tune costs the caller nothing after it is queued.  The tone itself is a
+// PWM output: the generator period is the note period and the duty cycle
+// sets the volume, so the ISR only runs once per note to load the next
+// one.  A rest disables the PWM output, which holds the pin low.  When the
+// last queued tune ends the timer is stopped and the time is recorded for
+// callers that hold off between tunes.
+
+// The PWM clock is the system clock / 4, so a generator period of up to
+// 65536 counts reaches down to 153 Hz at 40 MHz.  The speaker has its own
+// generator, so the period goes back to the default when a tune ends
+// without affecting the pump.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "clock.h"
+#include "kernel.h"
+#include "pwm.h"
+#include "melody.h"
+
+#define MAX_VOLUME 100
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+const TUNE* tuneQueue[MELODY_QUEUE_SIZE];
+volatile uint8_t tuneReadIndex = 0;
+volatile uint8_t tuneWriteIndex = 0;
+const TUNE* tune;
+uint8_t noteIndex;
+uint8_t tuneRepeat;
+uint8_t melodyVolume = MAX_VOLUME;
+volatile bool melodyPlaying = false;
+volatile uint64_t melodyStopTime = 0;
+uint32_t cyclesPerMs;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Stopped Timer2A, the speaker output is set up by initPwm
+void initMelody()
+{
+    cyclesPerMs = getSysClockHz() / 1000;
+
+    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R2;
+    _delay_cycles(3);
+
+    TIMER2_CTL_R &= ~TIMER_CTL_TAEN;
+    TIMER2_CFG_R = TIMER_CFG_32_BIT_TIMER;
+    TIMER2_TAMR_R = TIMER_TAMR_TAMR_PERIOD;
+    TIMER2_IMR_R = TIMER_IMR_TATOIM;
+    NVIC_EN0_R |= 1 << (INT_TIMER2A-16);
+}
+
+// Load the current note, the timer counter is written as well so the
+// note is not stretched to the length of the previous one
+static void startNote()
+{
+    const NOTE* note = &tune->notes[noteIndex];
+    uint32_t reload = note->duration * cyclesPerMs;
+    if (note->period == REST)
+        setPwmDuty(PWM_SPEAKER, 0);
+    else
+    {
+        setPwmPeriod(note->period * 2 / PWM_DIVIDER);
+        setPwmDuty(PWM_SPEAKER, melodyVolume * PWM_FULL_DUTY / (2 * MAX_VOLUME));
+    }
+    TIMER2_TAILR_R = reload;
+    TIMER2_TAV_R = reload;
+}
+
+static bool startNextTune()
+{
+    if (tuneReadIndex == tuneWriteIndex)
+        return false;
+    tune = tuneQueue[tuneReadIndex];
+    tuneReadIndex = (tuneReadIndex + 1) % MELODY_QUEUE_SIZE;
+    noteIndex = 0;
+    tuneRepeat = 0;
+    startNote();
+    return true;
+}
+
+static void endMelody()
+{
+    TIMER2_CTL_R &= ~TIMER_CTL_TAEN;
+    setPwmDuty(PWM_SPEAKER, 0);
+    setPwmPeriod(0);
+    melodyPlaying = false;
+    melodyStopTime = getTimestamp();
+}
+
+// End of a note
+void timer2Isr()
+{
+    TIMER2_ICR_R = TIMER_ICR_TATOCINT;
+    if (++noteIndex < tune->noteCount)
+        startNote();
+    else if (++tuneRepeat < tune->repeats)
+    {
+        noteIndex = 0;
+        startNote();
+    }
+    else if (!startNextTune())
+        endMelody();
+}
+
+// Queue a tune, it starts at once if nothing is playing
+// Returns false when the queue is full
+bool playTune(const TUNE* newTune)
+{
+    uint8_t next;
+    uint32_t mask;
+    if (newTune->noteCount == 0)
+        return true;
+    mask = enterCritical();
+    next = (tuneWriteIndex + 1) % MELODY_QUEUE_SIZE;
+    if (next == tuneReadIndex)
+    {
+        leaveCritical(mask);
+        return false;
+    }
+    tuneQueue[tuneWriteIndex] = newTune;
+    tuneWriteIndex = next;
+    if (!melodyPlaying)
+    {
+        melodyPlaying = true;
+        startNextTune();
+        TIMER2_CTL_R |= TIMER_CTL_TAEN;
+    }
+    leaveCritical(mask);
+    return true;
+}
+
+// Silence the speaker and drop any queued tunes
+void stopMelody()
+{
+    uint32_t mask = enterCritical();
+    tuneReadIndex = tuneWriteIndex;
+    if (melodyPlaying)
+        endMelody();
+    leaveCritical(mask);
+}
+
+bool isMelodyPlaying()
+{
+    return melodyPlaying;
+}
+
+// Timestamp clock value when the last tune ended
+uint64_t getMelodyStopTime()
+{
+    return melodyStopTime;
+}
+
+// Duty cycle as a percentage of the loudest (50 %) setting, takes effect
+// at the next note
+void setMelodyVolume(uint8_t volume)
+{
+    if (volume > MAX_VOLUME)
+        volume = MAX_VOLUME;
+    melodyVolume = volume;
+}
+
+uint8_t getMelodyVolume()
+{
+    return melodyVolume;
+}
@@ -0,0 +1,70 @@
+// Melody Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    Read from the clock library
+
+// Hardware configuration:
+// Speaker on PA6 through the PWM library
+// Timer2A steps the notes
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef MELODY_H_
+#define MELODY_H_
+
+#define MELODY_QUEUE_SIZE 4
+#define REST 0
+
+// Built-in note tables are computed by the compiler for the system clock
+// set up in initHw
+#define MELODY_CLOCK_HZ 40000000
+#define NOTE_PERIOD(centiHz) ((uint32_t)(((uint64_t)MELODY_CLOCK_HZ*50 + (centiHz)/2) / (centiHz)))
+
+// Octave 4 note frequencies in 1/100 Hz (S = sharp), halve for octave 3
+#define NOTE_C4  26163
+#define NOTE_C4S 27718
+#define NOTE_D4  29366
+#define NOTE_D4S 31113
+#define NOTE_E4  32963
+#define NOTE_F4  34923
+#define NOTE_F4S 36999
+#define NOTE_G4  39200
+#define NOTE_G4S 41530
+#define NOTE_A4  44000
+#define NOTE_A4S 46616
+#define NOTE_B4  49388
+
+typedef struct _NOTE
+{
+    uint32_t period;                            // system clocks per half wave, REST for silence
+    uint16_t duration;                          // ms
+} NOTE;
+
+typedef struct _TUNE
+{
+    const NOTE* notes;
+    uint8_t noteCount;
+    uint8_t repeats;                            // times the notes are played, at least 1
+} TUNE;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initMelody();
+bool playTune(const TUNE* tune);
+void stopMelody();
+bool isMelodyPlaying();
+uint64_t getMelodyStopTime();
+void setMelodyVolume(uint8_t volume);
+uint8_t getMelodyVolume();
+void timer2Isr();
+
+#endif
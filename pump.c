@@ -0,0 +1,232 @@
+// Pump Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// Pump on PF2 through the PWM library
+// Timer4A one-shot limits the pump run time
+
+// The pump runs at a run duty (1/1000) set directly or from a flow rate
+// setpoint.  startPump does not switch the motor fully on: it starts at
+// PUMP_START_DUTY and updatePump, called every PUMP_RAMP_STEP_MS by the
+// caller's task, raises the duty to the run duty over the ramp time so the
+// inrush current does not sag the battery.  stopPump switches off at once.
+//
+// Switching the pump on arms a Timer4A one-shot for the maximum run time.
+// If the pump is still on when it expires, pumpSafetyIsr switches it off
+// and counts a forced shutdown, so the pump stops on time even if the
+// tasks that should have stopped it are stuck.  A start while the pump is
+// already on leaves the timer running, so overlapping starts from several
+// callers can not keep the pump on past the limit.  stopPump disarms the
+// timer.  The ISR only switches the pump off: callers watch
+// getPumpShutdowns to close their valves.  The one-shot counts system
+// clocks in 32 bits, so getPumpMaxRunLimit caps the run time (107 s at
+// 40 MHz, 53 s at 80 MHz).
+//
+// Flow is modelled as linear in duty above the stall duty, from 0 at
+// PUMP_START_DUTY to the calibrated full flow at 100 %.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "clock.h"
+#include "pwm.h"
+#include "pump.h"
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+volatile bool pumpOn = false;
+uint16_t pumpDuty = 0;
+uint16_t pumpRunDuty = PWM_FULL_DUTY;
+uint32_t pumpRampMs = DEFAULT_PUMP_RAMP_MS;
+float pumpFullFlow = DEFAULT_PUMP_FULL_FLOW;
+uint32_t pumpMaxRunMs = DEFAULT_PUMP_MAX_RUN_MS;
+volatile uint32_t pumpShutdowns = 0;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Safety timer, armed when the pump switches on
+void initPump()
+{
+    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R4;
+    _delay_cycles(3);
+    TIMER4_CTL_R &= ~TIMER_CTL_TAEN;
+    TIMER4_CFG_R = TIMER_CFG_32_BIT_TIMER;
+    TIMER4_TAMR_R = TIMER_TAMR_TAMR_1_SHOT;
+    TIMER4_IMR_R = TIMER_IMR_TATOIM;
+    NVIC_EN2_R |= 1 << (INT_TIMER4A-16-64);
+}
+
+// Forces the pump off when it has run for the maximum time
+void pumpSafetyIsr()
+{
+    TIMER4_ICR_R = TIMER_ICR_TATOCINT;
+    if (pumpOn)
+    {
+        pumpOn = false;
+        pumpDuty = 0;
+        setPwmDuty(PWM_PUMP, 0);
+        pumpShutdowns++;
+    }
+}
+
+// A start while the pump is running (another zone valve opening) does
+// nothing, the duty and the safety timer carry on
+void startPump()
+{
+    if (pumpOn)
+        return;
+    TIMER4_CTL_R &= ~TIMER_CTL_TAEN;
+    pumpDuty = PUMP_START_DUTY;
+    if (pumpDuty > pumpRunDuty || pumpRampMs == 0)
+        pumpDuty = pumpRunDuty;
+    setPwmDuty(PWM_PUMP, pumpDuty);
+    TIMER4_TAILR_R = getPumpMaxRun() * (getSysClockHz() / 1000);
+    TIMER4_ICR_R = TIMER_ICR_TATOCINT;
+    TIMER4_CTL_R |= TIMER_CTL_TAEN;
+    pumpOn = true;
+}
+
+void stopPump()
+{
+    TIMER4_CTL_R &= ~TIMER_CTL_TAEN;
+    pumpOn = false;
+    pumpDuty = 0;
+    setPwmDuty(PWM_PUMP, 0);
+}
+
+// One ramp step, returns true while the duty is still changing
+bool updatePump()
+{
+    uint16_t step;
+    if (!pumpOn || pumpDuty == pumpRunDuty)
+        return false;
+    if (pumpRampMs == 0)
+        step = PWM_FULL_DUTY;                        // no soft start, straight to the run duty
+    else
+        step = (uint32_t)PWM_FULL_DUTY * PUMP_RAMP_STEP_MS / pumpRampMs;
+    if (step == 0)
+        step = 1;
+    if (pumpDuty < pumpRunDuty)
+        pumpDuty = pumpRunDuty - pumpDuty > step ? pumpDuty + step : pumpRunDuty;
+    else
+        pumpDuty = pumpRunDuty;                      // slowing down needs no ramp
+    setPwmDuty(PWM_PUMP, pumpDuty);
+    if (!pumpOn)
+    {
+        pumpDuty = 0;
+        setPwmDuty(PWM_PUMP, 0);                     // the safety timer fired during the update
+        return false;
+    }
+    return pumpDuty != pumpRunDuty;
+}
+
+bool isPumpOn()
+{
+    return pumpOn;
+}
+
+// Run duty in 1/1000, a running pump ramps to it on the next update
+bool setPumpDuty(uint16_t duty)
+{
+    if (duty < PUMP_START_DUTY || duty > PWM_FULL_DUTY)
+        return false;
+    pumpRunDuty = duty;
+    return true;
+}
+
+// Duty the pump is driven at now, 0 when off
+uint16_t getPumpDuty()
+{
+    return pumpDuty;
+}
+
+uint16_t getPumpRunDuty()
+{
+    return pumpRunDuty;
+}
+
+// Time to ramp from stall to full duty, 0 for no soft start
+// A ramp shorter than one step is no soft start either
+void setPumpRamp(uint32_t ms)
+{
+    if (ms < PUMP_RAMP_STEP_MS)
+        ms = 0;
+    pumpRampMs = ms;
+}
+
+uint32_t getPumpRamp()
+{
+    return pumpRampMs;
+}
+
+// Flow rate setpoint in mL/s, false if the pump can not deliver it
+bool setPumpFlow(float flow)
+{
+    float duty;
+    if (flow <= 0 || flow > pumpFullFlow)
+        return false;
+    duty = PUMP_START_DUTY + flow / pumpFullFlow * (PWM_FULL_DUTY - PUMP_START_DUTY);
+    pumpRunDuty = duty + 0.5f;
+    return true;
+}
+
+// Flow at the run duty in mL/s
+float getPumpFlow()
+{
+    return pumpFullFlow * (pumpRunDuty - PUMP_START_DUTY) / (PWM_FULL_DUTY - PUMP_START_DUTY);
+}
+
+// Calibration: measured flow at full duty in mL/s
+void setPumpFullFlow(float flow)
+{
+    if (flow > 0)
+        pumpFullFlow = flow;
+}
+
+float getPumpFullFlow()
+{
+    return pumpFullFlow;
+}
+
+// Longest the pump may run from switching on before the safety timer stops it
+bool setPumpMaxRun(uint32_t ms)
+{
+    if (ms == 0 || ms > getPumpMaxRunLimit())
+        return false;
+    pumpMaxRunMs = ms;
+    return true;
+}
+
+// Run time the timer applies, the setting cut to what it can count
+uint32_t getPumpMaxRun()
+{
+    if (pumpMaxRunMs > getPumpMaxRunLimit())
+        return getPumpMaxRunLimit();
+    return pumpMaxRunMs;
+}
+
+// Longest time the 32-bit one-shot can count at the system clock, in ms
+uint32_t getPumpMaxRunLimit()
+{
+    return 0xFFFFFFFF / (getSysClockHz() / 1000);
+}
+
+uint32_t getPumpShutdowns()
+{
+    return pumpShutdowns;
+}
@@ -0,0 +1,52 @@
+// Pump Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// Pump on PF2 through the PWM library
+// Timer4A one-shot limits the pump run time
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef PUMP_H_
+#define PUMP_H_
+
+#define PUMP_RAMP_STEP_MS 10
+#define DEFAULT_PUMP_RAMP_MS 500
+#define PUMP_START_DUTY 200                     // below this the motor stalls
+#define DEFAULT_PUMP_FULL_FLOW 20.0f            // mL/s at full duty
+#define DEFAULT_PUMP_MAX_RUN_MS 100000          // cut to getPumpMaxRunLimit above 42 MHz
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initPump();
+void startPump();
+void stopPump();
+bool updatePump();
+bool isPumpOn();
+bool setPumpDuty(uint16_t duty);
+uint16_t getPumpDuty();
+uint16_t getPumpRunDuty();
+void setPumpRamp(uint32_t ms);
+uint32_t getPumpRamp();
+bool setPumpFlow(float flow);
+float getPumpFlow();
+void setPumpFullFlow(float flow);
+float getPumpFullFlow();
+bool setPumpMaxRun(uint32_t ms);
+uint32_t getPumpMaxRun();
+uint32_t getPumpMaxRunLimit();
+uint32_t getPumpShutdowns();
+void pumpSafetyIsr();
+
+#endif
@@ -0,0 +1,140 @@
+// PWM Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    Read from the clock library
+
+// Hardware configuration:
+// PWM module 1 generators 1 and 3, clocked at the system clock / 4
+// Speaker on PA6 (M1PWM2, generator 1 output A)
+// Pump on PF2 (M1PWM6, generator 3 output A)
+
+// The speaker and pump have a generator each, so the melody library can
+// set the speaker period to the note being played while the pump stays at
+// PWM_PUMP_PERIOD, above hearing.  The speaker period is normally
+// PWM_DEFAULT_PERIOD.  Duty cycles are kept in 1/1000 and the speaker
+// compare value is recomputed whenever its period changes.  A duty of 0
+// disables the output, which holds the pin low.  Load and compare updates
+// are synchronized to the counter reaching zero, so changes never produce
+// a short pulse.
+
+// The melody library changes the speaker period and duty from its ISR
+// while the pump duty is changed from a task.  Each output's enable bit is
+// written through its bit-band alias and the speaker compare value is
+// rewritten if the period changed while it was being computed, so no
+// interrupt masking is needed.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "pwm.h"
+
+// Port masks
+#define SPEAKER_MASK 64                             // PA6
+#define PUMP_MASK 4                                 // PF2
+
+// Bitband aliases of the PWM1 ENABLE bits
+#define SPEAKER_PWM_ENABLE (*((volatile uint32_t *)(0x42000000 + (0x40029008-0x40000000)*32 + 2*4)))
+#define PUMP_PWM_ENABLE    (*((volatile uint32_t *)(0x42000000 + (0x40029008-0x40000000)*32 + 6*4)))
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+volatile uint32_t pwmPeriod = PWM_DEFAULT_PERIOD;
+volatile uint16_t pwmDuty[2] = {0, 0};
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Both outputs low, generators running at their default periods
+void initPwm()
+{
+    SYSCTL_RCC_R = (SYSCTL_RCC_R & ~SYSCTL_RCC_PWMDIV_M) | SYSCTL_RCC_USEPWMDIV | SYSCTL_RCC_PWMDIV_4;
+    SYSCTL_RCGCGPIO_R |= SYSCTL_RCGCGPIO_R0 | SYSCTL_RCGCGPIO_R5;
+    SYSCTL_RCGCPWM_R |= SYSCTL_RCGCPWM_R1;
+    _delay_cycles(3);
+
+    GPIO_PORTA_DEN_R |= SPEAKER_MASK;
+    GPIO_PORTA_AFSEL_R |= SPEAKER_MASK;
+    GPIO_PORTA_PCTL_R = (GPIO_PORTA_PCTL_R & ~GPIO_PCTL_PA6_M) | GPIO_PCTL_PA6_M1PWM2;
+    GPIO_PORTF_DEN_R |= PUMP_MASK;
+    GPIO_PORTF_AFSEL_R |= PUMP_MASK;
+    GPIO_PORTF_PCTL_R = (GPIO_PORTF_PCTL_R & ~GPIO_PCTL_PF2_M) | GPIO_PCTL_PF2_M1PWM6;
+
+    PWM1_ENABLE_R &= ~(PWM_ENABLE_PWM2EN | PWM_ENABLE_PWM6EN);
+    PWM1_1_CTL_R = 0;                                // count down, updates at zero
+    PWM1_1_GENA_R = PWM_1_GENA_ACTLOAD_ONE | PWM_1_GENA_ACTCMPAD_ZERO;
+    PWM1_1_LOAD_R = pwmPeriod - 1;
+    PWM1_1_CMPA_R = pwmPeriod - 1;
+    PWM1_1_CTL_R = PWM_1_CTL_ENABLE;
+    PWM1_3_CTL_R = 0;
+    PWM1_3_GENA_R = PWM_3_GENA_ACTLOAD_ONE | PWM_3_GENA_ACTCMPAD_ZERO;
+    PWM1_3_LOAD_R = PWM_PUMP_PERIOD - 1;
+    PWM1_3_CMPA_R = PWM_PUMP_PERIOD - 1;
+    PWM1_3_CTL_R = PWM_3_CTL_ENABLE;
+}
+
+// Output goes high at load and low at the compare value counting down
+static uint32_t getCompare(uint8_t output, uint32_t period)
+{
+    uint32_t high = period * pwmDuty[output] / PWM_FULL_DUTY;
+    if (high >= period)
+        high = period - 1;
+    return period - 1 - high;
+}
+
+static void updateCompare(uint8_t output)
+{
+    uint32_t period;
+    if (output == PWM_PUMP)
+    {
+        PWM1_3_CMPA_R = getCompare(output, PWM_PUMP_PERIOD);
+        return;
+    }
+    do
+    {
+        period = pwmPeriod;
+        PWM1_1_CMPA_R = getCompare(output, period);
+    } while (period != pwmPeriod);
+}
+
+// Speaker period in PWM clocks, 0 restores the default
+void setPwmPeriod(uint32_t period)
+{
+    if (period == 0)
+        period = PWM_DEFAULT_PERIOD;
+    if (period > PWM_MAX_PERIOD)
+        period = PWM_MAX_PERIOD;
+    if (period < 2)
+        period = 2;
+    pwmPeriod = period;
+    PWM1_1_LOAD_R = period - 1;
+    updateCompare(PWM_SPEAKER);
+}
+
+void setPwmDuty(uint8_t output, uint16_t duty)
+{
+    if (duty > PWM_FULL_DUTY)
+        duty = PWM_FULL_DUTY;
+    pwmDuty[output] = duty;
+    updateCompare(output);
+    if (output == PWM_SPEAKER)
+        SPEAKER_PWM_ENABLE = duty > 0;
+    else
+        PUMP_PWM_ENABLE = duty > 0;
+}
+
+uint16_t getPwmDuty(uint8_t output)
+{
+    return pwmDuty[output];
+}
@@ -0,0 +1,40 @@
+// PWM Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    Read from the clock library
+
+// Hardware configuration:
+// PWM module 1 generators 1 and 3, clocked at the system clock / 4
+// Speaker on PA6 (M1PWM2, generator 1 output A)
+// Pump on PF2 (M1PWM6, generator 3 output A)
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef PWM_H_
+#define PWM_H_
+
+#define PWM_SPEAKER 0
+#define PWM_PUMP 1
+#define PWM_DIVIDER 4
+#define PWM_DEFAULT_PERIOD 500                  // 20 kHz at 40 MHz, above hearing
+#define PWM_PUMP_PERIOD PWM_DEFAULT_PERIOD
+#define PWM_MAX_PERIOD 65536
+#define PWM_FULL_DUTY 1000                      // duty cycles are in 1/1000
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initPwm();
+void setPwmPeriod(uint32_t period);
+void setPwmDuty(uint8_t output, uint16_t duty);
+uint16_t getPwmDuty(uint8_t output);
+
+#endif
@@ -0,0 +1,178 @@
+// RTC Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// Hibernation module RTC (RTCC seconds, RTCSS 1/32768 s sub-seconds)
+// RTC drift calibration in the user flash region
+
+// Drift compensation:
+// syncRtc is given the true time (Unix seconds) from the host.  The first
+// call only loads the RTC and records the sync point in HIB_DATA.  Each
+// later call compares the RTC and host time elapsed since the last sync,
+// which is the residual error left after the trim already programmed.
+// The residual is added to the drift estimate, weighted by how long the
+// interval was (a 1 s host resolution is 11.6 ppm over a day but 278 ppm
+// over an hour), and the RTC is reloaded for the next interval.
+//
+// HIB_RTCT is loaded into the sub-seconds counter once every 64 seconds,
+// so trim = 0x7FFF + N lengthens one second in 64 by N/32768 s, which
+// slows the RTC by N / (64 * 32768) = N / 2.097152 ppm.  The estimate is
+// kept in flash so it survives losing the battery along with the time.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "tm4c123gh6pm.h"
+#include "hibernate.h"
+#include "flash.h"
+#include "rtc.h"
+
+#define RTC_TRIM_NOMINAL 0x7FFF
+#define RTC_TRIM_COUNTS_PER_PPM 2.097152f
+#define RTC_MAX_DRIFT_PPM 500.0f
+#define RTC_SYNC_MIN_SECONDS 600
+#define RTC_SYNC_FULL_WEIGHT_SECONDS 86400
+#define RTC_SYNC_MAGIC 0x53594E43
+#define RTC_CALIBRATION_ADDRESS 0x0003F400
+#define RTC_CALIBRATION_MAGIC 0x5452494D
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+float rtcDriftPpm = 0;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Current time as 32.15 fixed point (about 30 us resolution)
+// RTCC is read on both sides of RTCSS so a seconds rollover between the
+// two reads can not produce a time that is off by a second
+uint64_t getRtcTime()
+{
+    uint32_t seconds, subseconds;
+    do
+    {
+        seconds = HIB_RTCC_R;
+        subseconds = HIB_RTCSS_R & HIB_RTCSS_RTCSSC_M;
+    } while (seconds != HIB_RTCC_R);
+    return ((uint64_t)seconds << RTC_FRACTION_BITS) | subseconds;
+}
+
+uint32_t getRtcSeconds()
+{
+    return HIB_RTCC_R;
+}
+
+static void loadRtc(uint32_t seconds)
+{
+    waitHibernateWrite();
+    HIB_RTCLD_R = seconds;
+    waitHibernateWrite();
+}
+
+// A manual set is not a trustworthy reference, so it also ends the
+// current sync interval
+void setRtcSeconds(uint32_t seconds)
+{
+    loadRtc(seconds);
+    writeHibernateData(HIB_DATA_SYNC_MAGIC, 0);
+}
+
+// Positive drift is an RTC that runs fast, which needs a longer trim
+static void programRtcTrim()
+{
+    int32_t counts;
+    counts = (int32_t)(rtcDriftPpm * RTC_TRIM_COUNTS_PER_PPM + (rtcDriftPpm < 0 ? -0.5f : 0.5f));
+    waitHibernateWrite();
+    HIB_RTCT_R = RTC_TRIM_NOMINAL + counts;
+    waitHibernateWrite();
+}
+
+// Restore the stored drift estimate after any reset
+void initRtc()
+{
+    const uint32_t* calibration = (const uint32_t*)RTC_CALIBRATION_ADDRESS;
+    float ppm;
+    if (calibration[0] == RTC_CALIBRATION_MAGIC)
+    {
+        memcpy(&ppm, &calibration[1], sizeof(ppm));
+        if (ppm >= -RTC_MAX_DRIFT_PPM && ppm <= RTC_MAX_DRIFT_PPM)
+            rtcDriftPpm = ppm;
+    }
+    programRtcTrim();
+}
+
+static bool saveRtcDrift()
+{
+    uint32_t calibration[2];
+    calibration[0] = RTC_CALIBRATION_MAGIC;
+    memcpy(&calibration[1], &rtcDriftPpm, sizeof(rtcDriftPpm));
+    return writeFlashBlock(RTC_CALIBRATION_ADDRESS, calibration, 2);
+}
+
+// Load the RTC with the host time and refine the drift estimate
+RTC_SYNC_RESULT syncRtc(uint32_t hostSeconds)
+{
+    RTC_SYNC_RESULT result = RTC_SYNC_STARTED;
+    uint64_t rtcTime = getRtcTime();
+    uint32_t syncSeconds, hostElapsed;
+    float residual, weight;
+    if (readHibernateData(HIB_DATA_SYNC_MAGIC) == RTC_SYNC_MAGIC)
+    {
+        syncSeconds = readHibernateData(HIB_DATA_SYNC_TIME);
+        hostElapsed = hostSeconds - syncSeconds;
+        if ((int32_t)hostElapsed < RTC_SYNC_MIN_SECONDS)
+            result = RTC_SYNC_TOO_SOON;
+        else
+        {
+            residual = (float)((int64_t)(rtcTime - ((uint64_t)syncSeconds << RTC_FRACTION_BITS))
+                     - ((int64_t)hostElapsed << RTC_FRACTION_BITS))
+                     / ((float)hostElapsed * (1 << RTC_FRACTION_BITS)) * 1e6f;
+            weight = 1.0f;
+            if (hostElapsed < RTC_SYNC_FULL_WEIGHT_SECONDS)
+                weight = (float)hostElapsed / RTC_SYNC_FULL_WEIGHT_SECONDS;
+            if (residual < -RTC_MAX_DRIFT_PPM || residual > RTC_MAX_DRIFT_PPM)
+                result = RTC_SYNC_REJECTED;          // wrong host time, not drift
+            else
+            {
+                rtcDriftPpm += residual * weight;
+                if (rtcDriftPpm > RTC_MAX_DRIFT_PPM)
+                    rtcDriftPpm = RTC_MAX_DRIFT_PPM;
+                if (rtcDriftPpm < -RTC_MAX_DRIFT_PPM)
+                    rtcDriftPpm = -RTC_MAX_DRIFT_PPM;
+                programRtcTrim();
+                saveRtcDrift();
+                result = RTC_SYNC_UPDATED;
+            }
+        }
+        if (result == RTC_SYNC_TOO_SOON)
+            return result;                           // keep measuring from the old sync point
+    }
+    loadRtc(hostSeconds);
+    writeHibernateData(HIB_DATA_SYNC_TIME, hostSeconds);
+    writeHibernateData(HIB_DATA_SYNC_MAGIC, RTC_SYNC_MAGIC);
+    return result;
+}
+
+float getRtcDriftPpm()
+{
+    return rtcDriftPpm;
+}
+
+uint16_t getRtcTrim()
+{
+    return HIB_RTCT_R & HIB_RTCT_TRIM_M;
+}
@@ -0,0 +1,46 @@
+// RTC Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// Hibernation module RTC (RTCC seconds, RTCSS 1/32768 s sub-seconds)
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef RTC_H_
+#define RTC_H_
+
+// RTC times are 32.15 fixed point: seconds above bit 15, 1/32768 s below
+#define RTC_FRACTION_BITS 15
+#define RTC_SECONDS(t) ((uint32_t)((t) >> RTC_FRACTION_BITS))
+#define RTC_MILLISECONDS(t) ((uint32_t)((((t) & 0x7FFF) * 1000) >> RTC_FRACTION_BITS))
+
+typedef enum _RTC_SYNC_RESULT
+{
+    RTC_SYNC_STARTED,                   // first sync, reference recorded
+    RTC_SYNC_UPDATED,                   // drift estimate and trim updated
+    RTC_SYNC_TOO_SOON,                  // interval too short, RTC left running
+    RTC_SYNC_REJECTED                   // error too large to be drift, RTC reloaded
+} RTC_SYNC_RESULT;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initRtc();
+uint64_t getRtcTime();
+uint32_t getRtcSeconds();
+void setRtcSeconds(uint32_t seconds);
+RTC_SYNC_RESULT syncRtc(uint32_t hostSeconds);
+float getRtcDriftPpm();
+uint16_t getRtcTrim();
+
+#endif
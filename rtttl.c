@@ -0,0 +1,213 @@
+// RTTTL Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// None
+
+// Compiles ring tone text (RTTTL) into a melody note table, for example
+//   alarm:d=8,o=5,b=180:c,e,g,c6,4p,c6,g,e,4c
+// The name is ignored.  The defaults section sets the duration (d), octave
+// (o) and tempo in quarter notes per minute (b).  Each note is an optional
+// duration (1, 2, 4, 8, 16 or 32), a note letter a-g or p for a pause, an
+// optional # and an optional octave 3-7, with an optional dot (1.5 times
+// as long) before or after the octave.  Spaces are ignored.  A note lower
+// than the speaker PWM can play is an error: at 40 MHz that is C3 to D3.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "melody.h"
+#include "pwm.h"
+#include "rtttl.h"
+
+#define DEFAULT_DURATION 4
+#define DEFAULT_OCTAVE 6
+#define DEFAULT_BEATS 63
+#define MIN_OCTAVE 3
+#define MAX_OCTAVE 7
+#define MAX_NOTE_MS 0xFFFF
+#define MAX_NOTE_PERIOD ((uint32_t)PWM_MAX_PERIOD * PWM_DIVIDER / 2)   // melody loads period * 2 / PWM_DIVIDER
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+// Octave 4 semitones from C in 1/100 Hz
+const uint16_t octave4[12] = {NOTE_C4, NOTE_C4S, NOTE_D4, NOTE_D4S, NOTE_E4, NOTE_F4,
+                              NOTE_F4S, NOTE_G4, NOTE_G4S, NOTE_A4, NOTE_A4S, NOTE_B4};
+// Semitone of a-g from C
+const uint8_t letterSemitone[7] = {9, 11, 0, 2, 4, 5, 7};
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static const char* skipSpaces(const char* p)
+{
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+        p++;
+    return p;
+}
+
+static char lower(char c)
+{
+    if (c >= 'A' && c <= 'Z')
+        return c - 'A' + 'a';
+    return c;
+}
+
+static const char* readNumber(const char* p, uint16_t* value)
+{
+    *value = 0;
+    while (*p >= '0' && *p <= '9')
+    {
+        if (*value < 1000)
+            *value = *value*10 + (*p - '0');
+        p++;
+    }
+    return p;
+}
+
+static bool isDuration(uint16_t duration)
+{
+    return duration == 1 || duration == 2 || duration == 4 || duration == 8 || duration == 16 || duration == 32;
+}
+
+// Parses "d=4,o=5,b=120", returns a pointer past the closing ':' or 0
+static const char* readDefaults(const char* p, uint16_t* duration, uint16_t* octave, uint16_t* beats)
+{
+    char key;
+    uint16_t value;
+    while (true)
+    {
+        p = skipSpaces(p);
+        if (*p == ':')
+            return p + 1;
+        key = lower(*p);
+        p = skipSpaces(p + 1);
+        if (*p != '=')
+            return 0;
+        p = readNumber(skipSpaces(p + 1), &value);
+        if (key == 'd' && isDuration(value))
+            *duration = value;
+        else if (key == 'o' && value >= MIN_OCTAVE && value <= MAX_OCTAVE)
+            *octave = value;
+        else if (key == 'b' && value > 0)
+            *beats = value;
+        else
+            return 0;
+        p = skipSpaces(p);
+        if (*p == ',')
+            p++;
+        else if (*p != ':')
+            return 0;
+    }
+}
+
+// Half wave period in system clocks of a semitone in an octave
+static uint32_t getPeriod(uint8_t semitone, uint8_t octave, uint32_t clockHz)
+{
+    uint32_t period = (uint32_t)(((uint64_t)clockHz*50 + octave4[semitone]/2) / octave4[semitone]);
+    if (octave > 4)
+        period >>= octave - 4;
+    else
+        period <<= 4 - octave;
+    return period;
+}
+
+// Returns the number of notes written or 0 if the text is not valid RTTTL
+uint8_t compileRtttl(const char* text, NOTE notes[], uint8_t maxNotes, uint32_t clockHz)
+{
+    const char* p = text;
+    uint16_t defaultDuration = DEFAULT_DURATION, defaultOctave = DEFAULT_OCTAVE, beats = DEFAULT_BEATS;
+    uint16_t duration, octave;
+    uint32_t ms;
+    uint8_t count = 0;
+    int8_t semitone;
+    bool dotted;
+
+    while (*p != ':')                                // name
+    {
+        if (*p == '\0')
+            return 0;
+        p++;
+    }
+    p = readDefaults(p + 1, &defaultDuration, &defaultOctave, &beats);
+    if (p == 0)
+        return 0;
+
+    while (true)
+    {
+        p = skipSpaces(p);
+        if (*p == '\0')
+            break;
+        if (count == maxNotes)
+            return 0;
+        p = readNumber(p, &duration);
+        if (duration == 0)
+            duration = defaultDuration;
+        if (!isDuration(duration))
+            return 0;
+        if (lower(*p) == 'p')
+            semitone = -1;
+        else if (lower(*p) >= 'a' && lower(*p) <= 'g')
+            semitone = letterSemitone[lower(*p) - 'a'];
+        else
+            return 0;
+        p++;
+        if (*p == '#' && semitone >= 0)
+        {
+            semitone++;
+            p++;
+        }
+        dotted = *p == '.';
+        if (dotted)
+            p++;
+        p = readNumber(p, &octave);
+        if (octave == 0)
+            octave = defaultOctave;
+        if (octave < MIN_OCTAVE || octave > MAX_OCTAVE)
+            return 0;
+        if (*p == '.')
+        {
+            dotted = true;
+            p++;
+        }
+        if (semitone == 12)                          // b# is c of the next octave
+        {
+            semitone = 0;
+            if (++octave > MAX_OCTAVE)
+                return 0;
+        }
+
+        ms = 240000 / ((uint32_t)beats * duration);
+        if (dotted)
+            ms += ms / 2;
+        if (ms > MAX_NOTE_MS)
+            ms = MAX_NOTE_MS;
+        if (ms == 0)
+            ms = 1;
+        notes[count].period = semitone < 0 ? REST : getPeriod(semitone, octave, clockHz);
+        if (notes[count].period > MAX_NOTE_PERIOD)
+            return 0;
+        notes[count].duration = ms;
+        count++;
+
+        p = skipSpaces(p);
+        if (*p == ',')
+            p++;
+        else if (*p != '\0')
+            return 0;
+    }
+    return count;
+}
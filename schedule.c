@@ -0,0 +1,204 @@
+// Watering Schedule Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// None
+
+// Windows are compiled into one bit per minute of the week (10080 bits,
+// 180 bytes per day), so checking the schedule is a single bit test no
+// matter how many windows there are.  A window whose end is before its
+// start runs past midnight into the next day.  The minutes until the
+// next open/close change are found by scanning the bitmap a word at a
+// time and cached until that transition is reached.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "schedule.h"
+
+#define BITMAP_WORDS (MINUTES_PER_WEEK/32)
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+SCHEDULE_WINDOW windows[MAX_SCHEDULE_WINDOWS];
+uint8_t windowCount = 0;
+uint32_t scheduleBitmap[BITMAP_WORDS];
+
+// Cached transition: valid for minutes from transitionFrom up to transitionAt
+uint16_t transitionFrom = 0;
+uint32_t transitionAt = 0;
+bool transitionValid = false;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static void setMinutes(uint16_t from, uint16_t count)
+{
+    uint16_t m = from;
+    while (count--)
+    {
+        scheduleBitmap[m >> 5] |= 1u << (m & 31);
+        if (++m == MINUTES_PER_WEEK)
+            m = 0;
+    }
+}
+
+static void compileSchedule()
+{
+    uint8_t i, day;
+    uint16_t word, length;
+    for (word = 0; word < BITMAP_WORDS; word++)
+        scheduleBitmap[word] = 0;
+    for (i = 0; i < windowCount; i++)
+    {
+        if (windows[i].end > windows[i].start)
+            length = windows[i].end - windows[i].start;
+        else
+            length = MINUTES_PER_DAY - windows[i].start + windows[i].end;
+        for (day = 0; day < 7; day++)
+            if (windows[i].days & (1 << day))
+                setMinutes(day*MINUTES_PER_DAY + windows[i].start, length);
+    }
+    transitionValid = false;
+}
+
+void clearSchedule()
+{
+    windowCount = 0;
+    compileSchedule();
+}
+
+bool addScheduleWindow(uint16_t start, uint16_t end, uint8_t days)
+{
+    if (windowCount == MAX_SCHEDULE_WINDOWS || start >= MINUTES_PER_DAY || end >= MINUTES_PER_DAY || start == end)
+        return false;
+    windows[windowCount].start = start;
+    windows[windowCount].end = end;
+    windows[windowCount].days = days & ALL_DAYS;
+    windowCount++;
+    compileSchedule();
+    return true;
+}
+
+uint8_t getScheduleWindowCount()
+{
+    return windowCount;
+}
+
+bool getScheduleWindow(uint8_t window, SCHEDULE_WINDOW* info)
+{
+    if (window >= windowCount)
+        return false;
+    *info = windows[window];
+    return true;
+}
+
+// One word per window for battery-backed storage
+uint32_t packScheduleWindow(uint8_t window)
+{
+    return windows[window].start | ((uint32_t)windows[window].end << 11) | ((uint32_t)windows[window].days << 22);
+}
+
+bool addPackedScheduleWindow(uint32_t packed)
+{
+    return addScheduleWindow(packed & 0x7FF, (packed >> 11) & 0x7FF, (packed >> 22) & ALL_DAYS);
+}
+
+bool isScheduleOpen(uint16_t minuteOfWeek)
+{
+    return (scheduleBitmap[minuteOfWeek >> 5] >> (minuteOfWeek & 31)) & 1;
+}
+
+static bool isWindowOpen(uint8_t window, uint16_t minuteOfWeek)
+{
+    uint8_t day = minuteOfWeek / MINUTES_PER_DAY;
+    uint16_t minute = minuteOfWeek - day*MINUTES_PER_DAY;
+    uint8_t yesterday = day == 0 ? 6 : day - 1;
+    if (windows[window].end > windows[window].start)
+        return (windows[window].days & (1 << day)) && minute >= windows[window].start && minute < windows[window].end;
+    return ((windows[window].days & (1 << day)) && minute >= windows[window].start)
+        || ((windows[window].days & (1 << yesterday)) && minute < windows[window].end);
+}
+
+// Bit n set when window n is open, so each zone can follow its own windows
+// The bitmap answers the common closed case without looking at the windows
+uint8_t getOpenWindows(uint16_t minuteOfWeek)
+{
+    uint8_t window, open = 0;
+    if (!isScheduleOpen(minuteOfWeek))
+        return 0;
+    for (window = 0; window < windowCount; window++)
+        if (isWindowOpen(window, minuteOfWeek))
+            open |= 1 << window;
+    return open;
+}
+
+// Minutes until the last of the open windows in mask closes, 0 if none
+// of them is open.  This is the deadline for watering a zone
+uint16_t getMinutesToClose(uint8_t mask, uint16_t minuteOfWeek)
+{
+    uint8_t window, open = getOpenWindows(minuteOfWeek) & mask;
+    uint16_t minute = minuteOfWeek % MINUTES_PER_DAY;
+    uint16_t left, most = 0;
+    for (window = 0; window < windowCount; window++)
+    {
+        if (!(open & (1 << window)))
+            continue;
+        if (windows[window].end > minute)
+            left = windows[window].end - minute;
+        else
+            left = windows[window].end + MINUTES_PER_DAY - minute;   // closes after midnight
+        if (left > most)
+            most = left;
+    }
+    return most;
+}
+
+// Minutes from minuteOfWeek until the schedule opens or closes
+static uint32_t findTransition(uint16_t minuteOfWeek)
+{
+    uint32_t invert = isScheduleOpen(minuteOfWeek) ? 0xFFFFFFFF : 0;
+    uint16_t word = minuteOfWeek >> 5;
+    uint32_t bits = (scheduleBitmap[word] ^ invert) & ~((2u << (minuteOfWeek & 31)) - 1);
+    uint16_t scanned, bit;
+    for (scanned = 0; scanned <= BITMAP_WORDS; scanned++)
+    {
+        if (bits)
+        {
+            for (bit = 0; !(bits & (1u << bit)); bit++);
+            return ((uint32_t)word*32 + bit + MINUTES_PER_WEEK - minuteOfWeek) % MINUTES_PER_WEEK;
+        }
+        if (++word == BITMAP_WORDS)
+            word = 0;
+        bits = scheduleBitmap[word] ^ invert;
+    }
+    return NO_TRANSITION;
+}
+
+uint32_t getMinutesToTransition(uint16_t minuteOfWeek)
+{
+    uint16_t age = (minuteOfWeek + MINUTES_PER_WEEK - transitionFrom) % MINUTES_PER_WEEK;
+    if (!transitionValid || (transitionAt != NO_TRANSITION && age >= transitionAt))
+    {
+        transitionFrom = minuteOfWeek;
+        transitionAt = findTransition(minuteOfWeek);
+        transitionValid = true;
+        age = 0;
+    }
+    if (transitionAt == NO_TRANSITION)
+        return NO_TRANSITION;
+    return transitionAt - age;
+}
@@ -0,0 +1,50 @@
+// Watering Schedule Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// None
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef SCHEDULE_H_
+#define SCHEDULE_H_
+
+#define MAX_SCHEDULE_WINDOWS 6
+#define MINUTES_PER_DAY 1440
+#define MINUTES_PER_WEEK (7*MINUTES_PER_DAY)
+#define ALL_DAYS 0x7F                       // bit 0 = Sunday ... bit 6 = Saturday
+#define ALL_WINDOWS ((1 << MAX_SCHEDULE_WINDOWS) - 1)
+#define NO_TRANSITION 0xFFFFFFFF
+
+typedef struct _SCHEDULE_WINDOW
+{
+    uint16_t start;                         // minute of day, inclusive
+    uint16_t end;                           // minute of day, exclusive, may be before start
+    uint8_t days;                           // days on which the window opens
+} SCHEDULE_WINDOW;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void clearSchedule();
+bool addScheduleWindow(uint16_t start, uint16_t end, uint8_t days);
+uint8_t getScheduleWindowCount();
+bool getScheduleWindow(uint8_t window, SCHEDULE_WINDOW* info);
+uint32_t packScheduleWindow(uint8_t window);
+bool addPackedScheduleWindow(uint32_t packed);
+bool isScheduleOpen(uint16_t minuteOfWeek);
+uint8_t getOpenWindows(uint16_t minuteOfWeek);
+uint16_t getMinutesToClose(uint8_t mask, uint16_t minuteOfWeek);
+uint32_t getMinutesToTransition(uint16_t minuteOfWeek);
+
+#endif
@@ -0,0 +1,96 @@
+// Sensor Snapshot Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// None
+
+// Last value of each sensor with the kernel tick it was measured at.  A
+// consumer asks isSnapshotFresh with the oldest reading it will accept:
+// if the stored one is newer it uses getSnapshot, otherwise it measures
+// and stores.  So the console answers from the monitor's last pass while
+// a control decision can still insist on a new measurement.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "kernel.h"
+#include "zone.h"
+#include "snapshot.h"
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+float snapshotValue[SNAPSHOT_FIELDS];
+uint32_t snapshotTick[SNAPSHOT_FIELDS];
+bool snapshotValid[SNAPSHOT_FIELDS];
+uint32_t snapshotHits = 0;
+uint32_t snapshotReads = 0;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// True when the stored value is at most maxAgeMs old, false means the
+// caller measures and stores a new one
+bool isSnapshotFresh(uint8_t field, uint32_t maxAgeMs)
+{
+    if (field < SNAPSHOT_FIELDS && snapshotValid[field] && getTicks() - snapshotTick[field] <= maxAgeMs)
+    {
+        snapshotHits++;
+        return true;
+    }
+    snapshotReads++;
+    return false;
+}
+
+void storeSnapshot(uint8_t field, float value)
+{
+    if (field >= SNAPSHOT_FIELDS)
+        return;
+    snapshotValue[field] = value;
+    snapshotTick[field] = getTicks();
+    snapshotValid[field] = true;
+}
+
+float getSnapshot(uint8_t field)
+{
+    if (field >= SNAPSHOT_FIELDS)
+        return 0;
+    return snapshotValue[field];
+}
+
+// Milliseconds since the field was measured, NEVER_READ if it has not been
+uint32_t getSnapshotAge(uint8_t field)
+{
+    if (field >= SNAPSHOT_FIELDS || !snapshotValid[field])
+        return NEVER_READ;
+    return getTicks() - snapshotTick[field];
+}
+
+// The next request measures whatever its max age
+void invalidateSnapshot(uint8_t field)
+{
+    if (field < SNAPSHOT_FIELDS)
+        snapshotValid[field] = false;
+}
+
+uint32_t getSnapshotHits()
+{
+    return snapshotHits;
+}
+
+uint32_t getSnapshotReads()
+{
+    return snapshotReads;
+}
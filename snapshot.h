@@ -0,0 +1,40 @@
+// Sensor Snapshot Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// None
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+#define SNAPSHOT_VOLUME 0
+#define SNAPSHOT_LIGHT 1
+#define SNAPSHOT_BATTERY 2
+#define SNAPSHOT_MOISTURE 3                     // one field per zone from here on
+#define SNAPSHOT_FIELDS (SNAPSHOT_MOISTURE + NUM_ZONES)
+#define NEVER_READ 0xFFFFFFFF
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+bool isSnapshotFresh(uint8_t field, uint32_t maxAgeMs);
+void storeSnapshot(uint8_t field, float value);
+float getSnapshot(uint8_t field);
+uint32_t getSnapshotAge(uint8_t field);
+void invalidateSnapshot(uint8_t field);
+uint32_t getSnapshotHits();
+uint32_t getSnapshotReads();
+
+#endif
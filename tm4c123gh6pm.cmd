@@ -10,7 +10,8 @@
 
 MEMORY
 {
-    FLASH (RX) : origin = 0x00000000, length = 0x00040000
+    FLASH (RX) : origin = 0x00000000, length = 0x0003F000
+    /* 0x0003F000-0x0003FFFF is left unallocated for user data (see flash.h) */
     SRAM (RWX) : origin = 0x20000000, length = 0x00008000
 }
 
@@ -31,5 +31,6 @@ void putcUart0(char c);
 void putsUart0(char* str);
 char getcUart0();
 bool kbhitUart0();
+void uart0Isr();
 
 #endif
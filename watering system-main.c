@@ -5,18 +5,32 @@
 #include "tm4c123gh6pm.h"
 #include "uart0.h"
 #include "adc0.h"
+#include "console.h"
+#include "command.h"
+#include "flash.h"
+#include "kernel.h"
+#include "hibernate.h"
+#include "clock.h"
+#include "rtc.h"
+#include "calendar.h"
+#include "melody.h"
+#include "rtttl.h"
+#include "alert.h"
+#include "watering.h"
+#include "pwm.h"
+#include "pump.h"
+#include "schedule.h"
+#include "zone.h"
+#include "dispatch.h"
+#include "coroutine.h"
+#include "snapshot.h"
 
 //Port C BitBanding
 #define DEINT  (*((volatile uint32_t *)(0x42000000 + (0x400063FC-0x40000000)*32 + 4*4)))
 #define COMP   (*((volatile uint32_t *)(0x42000000 + (0x400063FC-0x40000000)*32 + 7*4)))
 
-//Port A Bitbanding
-#define PUMP   (*((volatile uint32_t *)(0x42000000 + (0x400043FC-0x40000000)*32 + 7*4)))
-#define SPEAKER (*((volatile uint32_t *)(0x42000000 + (0x400043FC-0x40000000)*32 + 6*4)))
-
 // PortE masks
 #define AIN3_MASK 1
-#define AIN2_MASK 2
 #define AIN1_MASK 4
 
 //Port C Masks
@@ -26,73 +40,207 @@
 // PortA masks
 #define UART_TX_MASK 2
 #define UART_RX_MASK 1
-#define MAX_CHARS 80
-#define MAX_FIELDS 6
-#define PUMP_MASK 128
-#define SPEAKER_MASK 64
-
-char FieldString[MAX_CHARS];
 
-typedef struct _USER_DATA
-{
-    char buffer[MAX_CHARS+1];
-    uint8_t fieldCount;
-    uint8_t fieldPosition[MAX_FIELDS];
-    char fieldType[MAX_FIELDS];
-} USER_DATA;
+// Boot script stored in the user flash region
+#define SCRIPT_ADDRESS 0x0003F800
+#define SCRIPT_SIZE 1024
+#define SCRIPT_MAGIC 0x53435250
+#define SCRIPT_MAX_CHARS (SCRIPT_SIZE-8)
+
+// Zone settings page: magic, zone count, the packed watering model of each
+// zone, then level | target << 8 | windows << 16 for each zone
+#define ZONE_ADDRESS 0x0003FC00
+#define ZONE_MAGIC 0x5A4F4E45
+#define ZONE_PAGE_WORDS (2+2*MAX_ZONES)
+#define DEFAULT_LEVEL 20
+#define DEFAULT_TARGET 60
+#define MAX_PERCENT 100
+
+// Uploaded alert tunes share one flash page, a 512 byte slot per alert
+// holding magic, note count, then the note table
+#define TUNE_ADDRESS 0x0003F000
+#define TUNE_SLOTS 2
+#define TUNE_SLOT_WORDS 128
+#define TUNE_MAGIC 0x54554E45
+#define TUNE_MAX_NOTES ((TUNE_SLOT_WORDS-2)*4/sizeof(NOTE))
+#define TUNE_TEXT_SIZE 512
+#define WATER_LOW_TUNE 0
+#define BATTERY_LOW_TUNE 1
+#define NO_TUNE_UPLOAD -1
+
+// Console verbosity: quiet prints results only, normal echoes each line,
+// debug also dumps the parsed fields (not built when NDEBUG is defined)
+#define VERBOSITY_QUIET 0
+#define VERBOSITY_NORMAL 1
+#define VERBOSITY_DEBUG 2
+
+// Receive queue filled by uart0Isr
+#define RX_BUFFER_SIZE 128
+
+// Thread priorities, 0 highest.  The control tasks share a priority so they
+// never preempt one another, the console runs below them and holds
+// controlLock (ceiling CONTROL_PRIORITY) while it executes a command
+#define PUMP_PRIORITY 0
+#define CONTROL_PRIORITY 1
+#define CONSOLE_PRIORITY 2
+
+// Thread stacks in words, the console nests a script run inside a command
+#define CONSOLE_STACK_WORDS 768
+#define MONITOR_STACK_WORDS 384
+#define WATERING_STACK_WORDS 256
+#define PUMP_STACK_WORDS 128
+#define DOSE_STACK_WORDS 384
+
+// Alert tunes are played one note per second, twice through.  A condition
+// that persists is repeated after its cooldown until acknowledged
+#define ALERT_REPEATS 2
+#define ALERT_NOTE_MS 1000
+#define ALERT_GAP_MS 1000
+#define WATER_LOW_ALERT 0
+#define BATTERY_LOW_ALERT 1
+#define WATER_LOW_PRIORITY 1
+#define BATTERY_LOW_PRIORITY 2
+#define WATER_LOW_COOLDOWN_S 900
+#define BATTERY_LOW_COOLDOWN_S 1800
+
+// Watering sequence of each zone, run as a coroutine (runZoneFlow).  Pulse
+// and soak times come from the watering controller, and a zone waiting to
+// pulse is queued with the dispatcher, which shares the pump and reservoir
+// between the zones
+#define WATERING_IDLE 0
+#define WATERING_WAIT 1
+#define WATERING_PULSE 2
+#define WATERING_SOAK 3
+#define MAX_WATERING_PULSES 10
+#define MONITOR_PERIOD_MS 1000
+
+// The pump is never run from a reservoir below this volume
+#define MIN_RESERVOIR_ML 200
+
+// Dosing stops at the requested drawdown, on an empty reservoir, when the
+// reservoir stops dropping (pump running dry or blocked), or after twice
+// the time the pump flow rate says the dose should take
+#define DOSE_SAMPLE_MS 500
+#define DOSE_STALL_MS 10000
+#define DOSE_MARGIN_MS 5000
+#define DOSE_MAX_MS 90000                   // inside the pump safety time
+
+// Oldest sensor reading each consumer accepts.  The monitor measures
+// everything once a period and the console answers from that pass;
+// readings a control decision acts on at once are measured again
+#define CONSOLE_MAX_AGE_MS 2000
+#define MONITOR_MAX_AGE_MS 0
+#define DISPATCH_MAX_AGE_MS 250
+#define DOSE_MAX_AGE_MS 0
+#define SOAK_MAX_AGE_MS 0
+
+// Deep sleep is only entered after the console has been quiet this long,
+// except after a deep sleep wake with no console input since
+#define DEEP_SLEEP_QUIET_MS 60000
+
+// Deep sleep state words after the schedule windows, two alert play
+// times per word
+#define ALERT_STATE (4+MAX_SCHEDULE_WINDOWS)
+#if ALERT_STATE+(MAX_ALERTS+1)/2 > HIB_DATA_STATE_WORDS
+#error Deep sleep state does not fit in HIB_DATA
+#endif
 
 //-----------------------------------------------------------------------------
 // Global variables
 //-----------------------------------------------------------------------------
 
+float light_level=5.0;
+uint8_t verbosity=VERBOSITY_NORMAL;
+
+// Script upload buffer: magic, length, then '\n' separated command lines
+bool scriptUploading=false;
+bool scriptRunning=false;
+uint32_t scriptBuffer[SCRIPT_SIZE/4];
+
+char rxBuffer[RX_BUFFER_SIZE];
+QUEUE rxQueue;
+USER_DATA consoleData;
+SEMAPHORE controlLock;
+
+uint32_t consoleStack[CONSOLE_STACK_WORDS];
+uint32_t monitorStack[MONITOR_STACK_WORDS];
+uint32_t wateringStack[WATERING_STACK_WORDS];
+uint32_t pumpStack[PUMP_STACK_WORDS];
+uint32_t doseStack[DOSE_STACK_WORDS];
+
+const NOTE waterLowNotes[]={{NOTE_PERIOD(NOTE_A4),ALERT_NOTE_MS},{NOTE_PERIOD(NOTE_G4S),ALERT_NOTE_MS},
+                            {NOTE_PERIOD(NOTE_G4),ALERT_NOTE_MS},{NOTE_PERIOD(NOTE_D4S),ALERT_NOTE_MS},
+                            {NOTE_PERIOD(NOTE_E4),ALERT_NOTE_MS},{NOTE_PERIOD(NOTE_F4),ALERT_NOTE_MS},
+                            {REST,ALERT_GAP_MS}};
+const NOTE batteryLowNotes[]={{NOTE_PERIOD(NOTE_A4S/2),ALERT_NOTE_MS},{NOTE_PERIOD(NOTE_B4/2),ALERT_NOTE_MS},
+                              {NOTE_PERIOD(NOTE_C4),ALERT_NOTE_MS},{REST,ALERT_GAP_MS}};
+const TUNE builtInTunes[TUNE_SLOTS]={{waterLowNotes,sizeof(waterLowNotes)/sizeof(waterLowNotes[0]),ALERT_REPEATS},
+                                     {batteryLowNotes,sizeof(batteryLowNotes)/sizeof(batteryLowNotes[0]),ALERT_REPEATS}};
+TUNE alertTunes[TUNE_SLOTS];
+
+// RTTTL upload: text is collected until end, then compiled into a copy
+// of the tune page
+int8_t tuneUploadSlot=NO_TUNE_UPLOAD;
+char tuneText[TUNE_TEXT_SIZE];
+uint16_t tuneTextLength;
+uint32_t tunePage[FLASH_PAGE_SIZE/4];
+
+// Zone state, one array per field so the monitor sweep reads each field
+// of every zone in turn
+uint8_t zoneLevel[NUM_ZONES];
+uint8_t zoneTarget[NUM_ZONES];
+uint8_t zoneWindows[NUM_ZONES];
+uint8_t zoneState[NUM_ZONES];
+uint8_t zonePulses[NUM_ZONES];
+uint32_t zonePulseMs[NUM_ZONES];
+float zonePulseMoisture[NUM_ZONES];
+uint32_t zoneSoakStart[NUM_ZONES];
+uint32_t zoneSoakMs[NUM_ZONES];
+COROUTINE zoneFlow[NUM_ZONES];
+uint32_t zonePage[ZONE_PAGE_WORDS];
+
+bool dosing=false;
+
+// A safety cutoff stops automatic watering until "pump clear"
+uint32_t pumpShutdownsSeen=0;
+bool pumpFault=false;
+uint32_t doseTarget;
+uint32_t doseStartVolume;
+uint32_t doseDelivered;
+uint32_t doseStartTick;
+uint32_t doseProgressTick;
+uint32_t doseTimeoutMs;
+
+uint32_t deepSleepMinutes=0;
+
+// 32.15 RTC times of the last sensor reading, pump pulse and alert
+uint64_t lastReadingTime=0;
+uint64_t lastPumpTime=0;
+uint64_t lastAlertTime=0;
+uint32_t lastConsoleTick=0;
+bool wokeFromHibernate=false;
+
 //-----------------------------------------------------------------------------
 // Subroutines
 //-----------------------------------------------------------------------------
 
-void waitMicrosecond(uint32_t us)
-{
-    __asm("WMS_LOOP0:   MOV  R1, #6");          // 1
-    __asm("WMS_LOOP1:   SUB  R1, #1");          // 6
-    __asm("             CBZ  R1, WMS_DONE1");   // 5+1*3
-    __asm("             NOP");                  // 5
-    __asm("             NOP");                  // 5
-    __asm("             B    WMS_LOOP1");       // 5*2 (speculative, so P=1)
-    __asm("WMS_DONE1:   SUB  R0, #1");          // 1
-    __asm("             CBZ  R0, WMS_DONE0");   // 1
-    __asm("             NOP");                  // 1
-    __asm("             B    WMS_LOOP0");       // 1*2 (speculative, so P=1)
-    __asm("WMS_DONE0:");                        // ---
-                                                // 40 clocks/us + error
-}
-
 void initHw()
 {
     SYSCTL_RCC_R = SYSCTL_RCC_XTAL_16MHZ | SYSCTL_RCC_OSCSRC_MAIN | SYSCTL_RCC_USESYSDIV | (4 << SYSCTL_RCC_SYSDIV_S);
+    initClock();
 
     //Enable Analog Comparator Clock
     SYSCTL_RCGCACMP_R |= SYSCTL_RCGCACMP_R0;
-    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R1 | SYSCTL_RCGCTIMER_R2;
 
     //Enable Clocks
     SYSCTL_RCGCGPIO_R |= SYSCTL_RCGCGPIO_R2 | SYSCTL_RCGCGPIO_R4 | SYSCTL_RCGCGPIO_R0;
     _delay_cycles(3);
 
-    //Configure Port A pins for pump and speaker as outputs
-    GPIO_PORTA_DIR_R |= PUMP_MASK;
-    GPIO_PORTA_DEN_R |= PUMP_MASK;
-    GPIO_PORTA_DIR_R |= SPEAKER_MASK;
-    GPIO_PORTA_DEN_R |= SPEAKER_MASK;
-
     // Configure AIN3 as an analog input
     GPIO_PORTE_AFSEL_R |= AIN3_MASK;
     GPIO_PORTE_DEN_R &= ~AIN3_MASK;
     GPIO_PORTE_AMSEL_R |= AIN3_MASK;
 
-    //Configure AIN2 as an analog input
-    GPIO_PORTE_AFSEL_R |= AIN2_MASK;
-    GPIO_PORTE_DEN_R &= ~AIN2_MASK;
-    GPIO_PORTE_AMSEL_R |= AIN2_MASK;
-
     //Configure AIN1 as an analog input
     GPIO_PORTE_AFSEL_R |= AIN1_MASK;
     GPIO_PORTE_DEN_R &= ~AIN1_MASK;
@@ -112,26 +260,6 @@ void initHw()
     waitMicrosecond(10);
     COMP_ACSTAT0_R |= COMP_ACSTAT0_OVAL;
 
-    //Configure Timer1
-    TIMER1_CTL_R &= ~TIMER_CTL_TAEN;
-    TIMER1_CFG_R = TIMER_CFG_32_BIT_TIMER;
-    TIMER1_TAMR_R = TIMER_TAMR_TAMR_PERIOD;
-    TIMER1_TAMR_R |=TIMER_TAMR_TACDIR;
-    TIMER1_CTL_R |= TIMER_CTL_TAEN;
-
-    //Configure Timer2
-    TIMER2_CTL_R &= ~TIMER_CTL_TAEN;
-    TIMER2_CFG_R = TIMER_CFG_32_BIT_TIMER;
-    TIMER2_TAMR_R = TIMER_TAMR_TAMR_PERIOD;
-    TIMER2_TAILR_R = 40000000;
-    TIMER2_IMR_R = TIMER_IMR_TATOIM;
-    NVIC_EN0_R |= 1 << (INT_TIMER2A-16);
-
-    //Configuration of Hibernation Module
-    HIB_IM_R |= HIB_IM_WC;
-    HIB_CTL_R |=HIB_CTL_CLK32EN;
-    while(HIB_MIS_R==0x0);
-    HIB_CTL_R |= HIB_CTL_RTCEN;
 }
 
 
@@ -161,12 +289,14 @@ void initUart0()
 
     // Configure UART0 to 115200 baud, 8N1 format
     UART0_CTL_R = 0;                                    // turn-off UART0 to allow safe programming
-    UART0_CC_R = UART_CC_CS_SYSCLK;                     // use system clock (40 MHz)
-    UART0_IBRD_R = 21;                                  // r = 40 MHz / (Nx115.2kHz), set floor(r)=21, where N=16
-    UART0_FBRD_R = 45;                                  // round(fract(r)*64)=45
+    UART0_CC_R = UART_CC_CS_SYSCLK;                     // use system clock
+    setUart0BaudRate(115200, getSysClockHz());          // 40 MHz gives IBRD=21, FBRD=45
     UART0_LCRH_R = UART_LCRH_WLEN_8 | UART_LCRH_FEN;    // configure for 8N1 w/ 16-level FIFO
     UART0_CTL_R = UART_CTL_TXE | UART_CTL_RXE | UART_CTL_UARTEN;
                                                         // enable TX, RX, and module
+    UART0_IM_R = UART_IM_RXIM | UART_IM_RTIM;           // interrupt on RX FIFO level and timeout
+    initQueue(&rxQueue,rxBuffer,1,RX_BUFFER_SIZE);
+    NVIC_EN0_R |= 1 << (INT_UART0-16);
 }
 
 // Set baud rate as function of instruction cycle frequency
@@ -193,242 +323,55 @@ void putsUart0(char* str)
         putcUart0(str[i++]);
 }
 
-// Blocking function that returns with serial data once the buffer is not empty
-char getcUart0()
-{
-    while (UART0_FR_R & UART_FR_RXFE);               // wait if uart0 rx fifo empty
-    return UART0_DR_R & 0xFF;                        // get character from fifo
-}
-
+void wateringTask();
+void pumpTask();
+void doseTask();
 
-void getsUart0(USER_DATA* data)
+// Moves received characters into the queue so nothing is lost while a
+// task is busy, the console blocks on it (characters past a full queue
+// are dropped)
+void uart0Isr()
 {
-    int count=0;
     char c;
-    while(1)
+    while (!(UART0_FR_R & UART_FR_RXFE))
     {
-        //if(kbhitUart0())
-        //{
-            c=getcUart0();
-            if((c==8 || c==127) && count>0)
-            {
-                count--;
-            }
-
-            else if(c==13)
-            {
-                data->buffer[count]='\0';
-                return;
-            }
-
-            else if(c>=32)
-            {
-                data->buffer[count]=c;
-                count++;
-                if(count==MAX_CHARS)
-                {
-                    data->buffer[count]='\0';
-                    return ;
-                }
-            }
-        //}
-        //else
-        //{
-          //  kbhitUart0();
-          //  return;
-        //}
+        c = UART0_DR_R & 0xFF;
+        putQueue(&rxQueue, &c);
     }
-}
-// Returns the status of the receive buffer
-bool kbhitUart0()
-{
-    return !(UART0_FR_R & UART_FR_RXFE);
-}
-
-int stringCompare(const char *str1, const char *str2)
-{
-    int i = 0;
-    while(str1[i] == str2[i])
-    {
-        if(str1[i] == '\0' && str2[i] == '\0')
-            break;
-            i++;
-    }
-    return str1[i] - str2[i];
-}
-
-int atoi(char* str)
-{
-    int res = 0; // Initialize result
-    int i;
-    // Iterate through all characters of input string and
-    // update result
-    for (i = 0; str[i] != '\0'; i++)
-        res = res * 10 + str[i] - '0';
-
-    // return result.
-    return res;
-}
-
-void parseFields(USER_DATA* data)
-{
-    int counter = 0;
-    int field_count = 0;
-    int counter_two;
-    while (true)
-    {
-        if ((data->fieldType[field_count-1] != 'a') || (counter == 0))
-        {
-            if (((data->buffer[counter] >= 65) && (data->buffer[counter] <= 90)) || ((data->buffer[counter] >= 97) && (data->buffer[counter] <= 122)))
-            {
-                if(data->fieldType[field_count-1] == 'd')
-                {
-                    data->fieldType[field_count-1] = 'a';
-                    data->fieldPosition[field_count-1] = counter;
-                }
-                else
-                {
-                    data->fieldType[field_count] = 'a';
-                    data->fieldPosition[field_count] = counter;
-                    field_count++;
-                }
-            }
-        }
-        if ((data->fieldType[field_count-1] != 'n') || (counter == 0))
-        {
-            if ((data->buffer[counter] >= 48) && (data->buffer[counter] <= 57))
-            {
-                if(data->fieldType[field_count-1] == 'd')
-                {
-                    data->fieldType[field_count-1] = 'n';
-                    data->fieldPosition[field_count-1] = counter;
-                }
-                else
-                {
-                    data->fieldType[field_count] = 'n';
-                    data->fieldPosition[field_count] = counter;
-                    field_count++;
-                }
-            }
-        }
-        if (!((data->buffer[counter] >= 65) && (data->buffer[counter] <= 90)) && (data->fieldType[field_count-1] != 'd'))
-        {
-            if (!((data->buffer[counter] >= 97) && (data->buffer[counter] <= 122)))
-            {
-                if (!((data->buffer[counter] >= 48) && (data->buffer[counter] <= 57)))
-                {
-                    data->fieldType[field_count] = 'd';
-                    field_count++;
-                }
-            }
-        }
-        if ((field_count == MAX_FIELDS) || (data->buffer[counter] == '\0'))
-        {
-            for (counter_two = 0; counter_two <= counter; counter_two ++)
-            {
-                if (!((data->buffer[counter_two] >= 65) && (data->buffer[counter_two] <= 90)))
-                {
-                    if (!((data->buffer[counter_two] >= 97) && (data->buffer[counter_two] <= 122)))
-                    {
-                        if (!((data->buffer[counter_two] >= 48) && (data->buffer[counter_two] <= 57)))
-                        {
-                            data->buffer[counter_two] = '\0';
-                        }
-                    }
-                }
-                if ((data->fieldType[counter_two] == 'd') && (counter_two <= 5))
-                {
-                    data->fieldType[counter_two] = '\0';
-                }
-             }
-            data->fieldCount = field_count-1;
-            return;
-        }
-        counter++;
-
-     }
-
+    UART0_ICR_R = UART_ICR_RXIC | UART_ICR_RTIC;
 }
 
-
-char* getFieldString(USER_DATA* data, uint8_t fieldNumber)
+// Blocking function that returns with serial data once the queue is not empty
+char getcUart0()
 {
-   int counter=0;
-   int counter2= data->fieldPosition[fieldNumber];
-   if(fieldNumber <= MAX_FIELDS)
-   {
-       while(data->buffer[counter2] != '\0')
-       {
-           FieldString[counter]=data->buffer[counter2];
-           counter++;
-           counter2++;
-
-       }
-       FieldString[counter]= '\0';
-       return FieldString;
-   }
-   else
-   {
-     FieldString[0]='\0';
-     return FieldString;
-   }
-
-
+    char c;
+    getQueue(&rxQueue, &c);                          // blocks the calling task
+    return c;
 }
 
-uint32_t getFieldInteger(USER_DATA* data, uint8_t fieldNumber)
+// Returns the status of the receive queue
+bool kbhitUart0()
 {
-    uint32_t integer_pointer;
-    int counter=0;
-    int counter2= data->fieldPosition[fieldNumber];
-    if(fieldNumber <= MAX_FIELDS)
-       {
-           while(data->buffer[counter2]!= '\0')
-           {
-               FieldString[counter]=data->buffer[counter2];
-               counter++;
-               counter2++;
-           }
-           FieldString[counter]= '\0';
-           integer_pointer= atoi(&FieldString);
-           return integer_pointer;
-       }
-       else
-       {
-         integer_pointer=0;
-         return integer_pointer;
-       }
-
+    return getQueueCount(&rxQueue) > 0;
 }
 
-bool isCommand(USER_DATA* data, const char strCommand[], uint8_t minArguments)
-{
-    char* firstField= '\0';
-    firstField = getFieldString(data,0);
-    if(stringCompare(firstField,strCommand)==0 && data->fieldCount >= minArguments)
-    {
-        return true;
-    }
-
-    return false;
-}
-
-
+// Times the sensor capacitor charge against the free-running clock,
+// without disturbing it
 uint32_t getVolume()
 {
     uint32_t result=0;
+    uint32_t start;
     DEINT=1;
     DEINT=0;
 
     DEINT=1;
     while(COMP_ACSTAT0_R == 0x0);
 
-    TIMER1_TAV_R=0;
     DEINT=0;
-    TIMER1_TAV_R=0;
+    start=(uint32_t)getTimestamp();
 
     while(COMP_ACSTAT0_R !=0x0);
-    result = (TIMER1_TAV_R-344)/1.472;
+    result = ((uint32_t)getTimestamp()-start-344)/1.472;
 
 
 
@@ -454,19 +397,6 @@ float getLightPercentage()
 
 }
 
-float getMoisturePercentage()
-{
-    float MoisturePercent=0;
-    float rawValue=0;
-    setAdc0Ss3Mux(2);
-    setAdc0Ss3Log2AverageCount(4);
-    rawValue= readAdc0Ss3();
-    rawValue= ((rawValue+0.5) / 4096 * 3.3);
-    MoisturePercent= (rawValue/3.264148)*100;
-    MoisturePercent= 100-MoisturePercent;
-    return MoisturePercent;
-}
-
 float getBatteryVoltage()
 {
     float Voltage=0;
@@ -479,304 +409,1232 @@ float getBatteryVoltage()
     return Voltage;
 }
 
+// Sensor readings through the snapshot cache, measured only when the
+// stored one is older than maxAgeMs
+uint32_t getVolumeReading(uint32_t maxAgeMs)
+{
+    if(!isSnapshotFresh(SNAPSHOT_VOLUME,maxAgeMs))
+        storeSnapshot(SNAPSHOT_VOLUME,getVolume());
+    return getSnapshot(SNAPSHOT_VOLUME);
+}
+
+float getLightReading(uint32_t maxAgeMs)
+{
+    if(!isSnapshotFresh(SNAPSHOT_LIGHT,maxAgeMs))
+        storeSnapshot(SNAPSHOT_LIGHT,getLightPercentage());
+    return getSnapshot(SNAPSHOT_LIGHT);
+}
+
+float getBatteryReading(uint32_t maxAgeMs)
+{
+    if(!isSnapshotFresh(SNAPSHOT_BATTERY,maxAgeMs))
+        storeSnapshot(SNAPSHOT_BATTERY,getBatteryVoltage());
+    return getSnapshot(SNAPSHOT_BATTERY);
+}
+
+float getMoistureReading(uint8_t zone,uint32_t maxAgeMs)
+{
+    if(!isSnapshotFresh(SNAPSHOT_MOISTURE+zone,maxAgeMs))
+        storeSnapshot(SNAPSHOT_MOISTURE+zone,readZoneMoisture(zone));
+    return getSnapshot(SNAPSHOT_MOISTURE+zone);
+}
+
+// The pump task ramps the duty up after a start (soft start)
 void enablePump()
 {
-    PUMP=1;
+    startPump();
+    resumeTask(pumpTask);
     return;
 }
 
 void disablePump()
 {
-    PUMP=0;
+    stopPump();
     return;
 }
 
-void timer2Isr()
+// Opens the zone valve and runs the pump through it, the stored
+// reservoir volume is out of date once water moves
+void openZone(uint8_t zone)
+{
+    setZoneValve(zone,true);
+    enablePump();
+    invalidateSnapshot(SNAPSHOT_VOLUME);
+}
+
+// The pump stops with the last valve
+void closeZone(uint8_t zone)
 {
-    SPEAKER ^= 1;
-    TIMER2_ICR_R = TIMER_ICR_TATOCINT;
+    setZoneValve(zone,false);
+    if(getOpenValveCount()==0)
+        disablePump();
+    invalidateSnapshot(SNAPSHOT_VOLUME);
 }
-void playBatteryLowAlert()
+
+bool isWatering()
 {
-   uint32_t count=0;
+    uint8_t zone;
+    for(zone=0;zone<NUM_ZONES;zone++)
+        if(zoneState[zone]!=WATERING_IDLE)
+            return true;
+    return false;
+}
 
-   while(count!=2)
-   {
-       TIMER2_TAILR_R = 85837;
-       TIMER2_CTL_R |= TIMER_CTL_TAEN;
-       waitMicrosecond(1000000);
-       TIMER2_CTL_R &= ~TIMER_CTL_TAEN;
+// Starts a background dose of mL from the reservoir through one zone
+bool startDose(uint32_t mL,uint32_t zone)
+{
+    uint32_t volume=getVolumeReading(DOSE_MAX_AGE_MS);
+    if(dosing || isWatering() || zone>=NUM_ZONES || mL==0 || volume<=MIN_RESERVOIR_ML)
+        return false;
+    doseTarget=mL;
+    doseStartVolume=volume;
+    doseDelivered=0;
+    doseStartTick=getTicks();
+    doseProgressTick=doseStartTick;
+    doseTimeoutMs=DOSE_MAX_MS;
+    if(getPumpFlow()>0 && mL*2000/getPumpFlow()+DOSE_MARGIN_MS<DOSE_MAX_MS)
+        doseTimeoutMs=mL*2000/getPumpFlow()+DOSE_MARGIN_MS;
+    dosing=true;
+    openZone(zone);
+    lastPumpTime=getRtcTime();
+    resumeTask(doseTask);
+    return true;
+}
 
-       TIMER2_TAILR_R = 80972;
-       TIMER2_CTL_R |= TIMER_CTL_TAEN;
-       waitMicrosecond(1000000);
-       TIMER2_CTL_R &= ~TIMER_CTL_TAEN;
+void finishDose(const char* reason)
+{
+    char string[80];
+    closeAllValves();
+    disablePump();
+    dosing=false;
+    sprintf(string,"Dose %s: %u of %u mL in %u ms\r\n",reason,doseDelivered,doseTarget,getTicks()-doseStartTick);
+    putsUart0(string);
+}
 
-       TIMER2_TAILR_R = 76336;
-       TIMER2_CTL_R |= TIMER_CTL_TAEN;
-       waitMicrosecond(1000000);
-       TIMER2_CTL_R &= ~TIMER_CTL_TAEN;
-       count++;
-   }
-   return;
+// Raises or clears the alert conditions, alerts only sound in daylight
+void updateAlerts(uint32_t volume,float BatteryLevel,float light)
+{
+    setAlertCondition(WATER_LOW_ALERT,volume<MIN_RESERVOIR_ML);
+    setAlertCondition(BATTERY_LOW_ALERT,BatteryLevel<4);
+    if(serviceAlerts(light>=light_level)!=NO_ALERT)
+        lastAlertTime=getRtcTime();
 }
 
-void playWaterLowAlert()
+bool isWateringAllowed()
 {
-    uint32_t count=0;
+    return isScheduleOpen(getMinuteOfWeek());
+}
 
-    while(count!=2)
+void executeLine(const char* line);
+
+// Zone settings and learned models come from flash at every boot
+void loadZones()
+{
+    const uint32_t* stored=(const uint32_t*)ZONE_ADDRESS;
+    uint8_t zone;
+    for(zone=0;zone<NUM_ZONES;zone++)
     {
-        TIMER2_TAILR_R = 45455;
-        TIMER2_CTL_R |= TIMER_CTL_TAEN;
-        waitMicrosecond(1000000);
-        TIMER2_CTL_R &= ~TIMER_CTL_TAEN;
+        zoneLevel[zone]=DEFAULT_LEVEL;
+        zoneTarget[zone]=DEFAULT_TARGET;
+        zoneWindows[zone]=ALL_WINDOWS;
+        resetWateringModel(zone);
+        if(stored[0]==ZONE_MAGIC && zone<stored[1])
+        {
+            unpackWateringModel(zone,stored[2+zone]);
+            zoneLevel[zone]=stored[2+MAX_ZONES+zone] & 0xFF;
+            zoneTarget[zone]=(stored[2+MAX_ZONES+zone] >> 8) & 0xFF;
+            zoneWindows[zone]=(stored[2+MAX_ZONES+zone] >> 16) & ALL_WINDOWS;
+        }
+    }
+}
 
-        TIMER2_TAILR_R = 48135;
-        TIMER2_CTL_R |= TIMER_CTL_TAEN;
-        waitMicrosecond(1000000);
-        TIMER2_CTL_R &= ~TIMER_CTL_TAEN;
+// Only rewritten when something changed, to spare the flash
+bool saveZones()
+{
+    uint8_t zone;
+    memset(zonePage,0,sizeof(zonePage));
+    zonePage[0]=ZONE_MAGIC;
+    zonePage[1]=NUM_ZONES;
+    for(zone=0;zone<NUM_ZONES;zone++)
+    {
+        zonePage[2+zone]=packWateringModel(zone);
+        zonePage[2+MAX_ZONES+zone]=zoneLevel[zone] | (zoneTarget[zone] << 8) | ((uint32_t)zoneWindows[zone] << 16);
+    }
+    if(memcmp(zonePage,(const void*)ZONE_ADDRESS,sizeof(zonePage))==0)
+        return true;
+    return writeFlashBlock(ZONE_ADDRESS,zonePage,ZONE_PAGE_WORDS);
+}
 
-        TIMER2_TAILR_R = 51020;
-        TIMER2_CTL_R |= TIMER_CTL_TAEN;
-        waitMicrosecond(1000000);
-        TIMER2_CTL_R &= ~TIMER_CTL_TAEN;
+// Configuration kept in HIB_DATA across deep sleep, the zones are in flash
+void saveControllerState(uint32_t state[])
+{
+    uint8_t i;
+    memcpy(&state[0],&light_level,4);
+    state[1]=verbosity | (getAcknowledgedAlerts() << 8);
+    state[2]=deepSleepMinutes;
+    state[3]=getScheduleWindowCount();
+    for(i=0;i<getScheduleWindowCount();i++)
+        state[4+i]=packScheduleWindow(i);
+    for(i=0;i<MAX_ALERTS;i+=2)
+        state[ALERT_STATE+i/2]=packAlertPlayTime(i) | ((uint32_t)packAlertPlayTime(i+1) << 16);
+}
 
-        TIMER2_TAILR_R = 64309;
-        TIMER2_CTL_R |= TIMER_CTL_TAEN;
-        waitMicrosecond(1000000);
-        TIMER2_CTL_R &= ~TIMER_CTL_TAEN;
+bool restoreControllerState()
+{
+    uint32_t state[HIB_DATA_STATE_WORDS];
+    uint8_t i;
+    if(!loadHibernateState(state))
+        return false;
+    memcpy(&light_level,&state[0],4);
+    verbosity=state[1] & 0xFF;
+    restoreAcknowledgedAlerts(state[1] >> 8);
+    deepSleepMinutes=state[2];
+    clearSchedule();
+    for(i=0;i<state[3] && i<MAX_SCHEDULE_WINDOWS;i++)
+        addPackedScheduleWindow(state[4+i]);
+    for(i=0;i<MAX_ALERTS;i++)
+        restorePackedAlertPlayTime(i,state[ALERT_STATE+i/2] >> (i%2*16));
+    return true;
+}
 
-        TIMER2_TAILR_R = 60698;
-        TIMER2_CTL_R |= TIMER_CTL_TAEN;
-        waitMicrosecond(1000000);
-        TIMER2_CTL_R &= ~TIMER_CTL_TAEN;
+// Hibernate until the next check, or until the schedule opens or closes
+// if that comes first, when nothing is going on
+void checkDeepSleep()
+{
+    uint32_t state[HIB_DATA_STATE_WORDS];
+    uint32_t minutes=deepSleepMinutes;
+    if(deepSleepMinutes==0 || isWatering() || isAlertBusy() || isPumpOn())
+        return;
+    if((!wokeFromHibernate && getTicks()-lastConsoleTick<DEEP_SLEEP_QUIET_MS) || kbhitUart0())
+        return;
+    if(getMinutesToTransition(getMinuteOfWeek())<minutes)
+        minutes=getMinutesToTransition(getMinuteOfWeek());
+    if(minutes==0)
+        minutes=1;
+    saveZones();
+    saveControllerState(state);
+    hibernateUntil(getRtcSeconds()+minutes*60,state);
+}
 
-        TIMER2_TAILR_R = 57307;
-        TIMER2_CTL_R |= TIMER_CTL_TAEN;
-        waitMicrosecond(1000000);
-        TIMER2_CTL_R &= ~TIMER_CTL_TAEN;
-        count++;
+void saveScript()
+{
+    char string[60];
+    scriptBuffer[0]=SCRIPT_MAGIC;
+    if(writeFlashBlock(SCRIPT_ADDRESS,scriptBuffer,2+(scriptBuffer[1]+3)/4))
+    {
+        sprintf(string,"Script saved (%u bytes)\r\n",scriptBuffer[1]);
+        putsUart0(string);
+    }
+    else
+    {
+        putsUart0("Script save failed\r\n");
     }
-    return;
 }
 
-int getCurrentSeconds()
+// Collects one line of an upload, "end" closes the upload and writes flash
+// Alerts play the uploaded tune of their slot, if any, from flash
+void loadAlertTunes()
 {
-    int current_sec=0;
-    current_sec=HIB_RTCC_R;
-    current_sec=current_sec % 86400;
-    return current_sec;
+    const uint32_t* slot;
+    uint8_t i;
+    for(i=0;i<TUNE_SLOTS;i++)
+    {
+        slot=(const uint32_t*)(TUNE_ADDRESS+i*TUNE_SLOT_WORDS*4);
+        alertTunes[i]=builtInTunes[i];
+        if(slot[0]==TUNE_MAGIC && slot[1]>0 && slot[1]<=TUNE_MAX_NOTES)
+        {
+            alertTunes[i].notes=(const NOTE*)&slot[2];
+            alertTunes[i].noteCount=slot[1];
+        }
+    }
+}
 
+// Write back tunePage with count notes already in place in slot, count 0
+// clears the slot.  The page is erased, so nothing may be playing from it
+bool writeTuneSlot(uint8_t slot,uint8_t count)
+{
+    bool ok;
+    stopMelody();
+    tunePage[slot*TUNE_SLOT_WORDS]=count>0 ? TUNE_MAGIC : 0;
+    tunePage[slot*TUNE_SLOT_WORDS+1]=count;
+    ok=writeFlashBlock(TUNE_ADDRESS,tunePage,FLASH_PAGE_SIZE/4);
+    loadAlertTunes();
+    return ok;
 }
 
-bool isWateringAllowed(int lowerLimit,int upperLimit)
+// Compile the uploaded text, a gap rest is added so repeats are spaced
+// like the built-in tunes
+void saveTune()
 {
-    int time=getCurrentSeconds();
-    if(time>lowerLimit && time<upperLimit)
+    char string[60];
+    NOTE* notes=(NOTE*)&tunePage[tuneUploadSlot*TUNE_SLOT_WORDS+2];
+    uint8_t count;
+    tuneText[tuneTextLength]='\0';
+    memcpy(tunePage,(const void*)TUNE_ADDRESS,FLASH_PAGE_SIZE);
+    count=compileRtttl(tuneText,notes,TUNE_MAX_NOTES-1,getSysClockHz());
+    if(count==0)
     {
-        return true;
+        putsUart0("Invalid RTTTL\r\n");
+        return;
+    }
+    notes[count].period=REST;
+    notes[count].duration=ALERT_GAP_MS;
+    count++;
+    if(writeTuneSlot(tuneUploadSlot,count))
+    {
+        sprintf(string,"Tune saved (%u notes)\r\n",count);
+        putsUart0(string);
+    }
+    else
+    {
+        putsUart0("Tune save failed\r\n");
     }
-    return false;
 }
 
-int main()
+// Lines are joined as is, RTTTL ignores where they were split
+void appendTuneLine(const char* line)
 {
-    USER_DATA data;
-    char string[100];
-    uint32_t volume;
-    float light;
-    float moisture;
-    float BatteryLevel;
-    float level=20.0;
-    int lowerWindow=43200;
-    int upperWindow=61200;
-    int seconds_day=0;
-    bool watering;
-    float light_level=5.0;
-    initHw();
-    initUart0();
-    initAdc0Ss3();
+    uint8_t i;
+    if(stringCompare(line,"end")==0)
+    {
+        saveTune();
+        tuneUploadSlot=NO_TUNE_UPLOAD;
+        return;
+    }
+    for(i=0;line[i]!='\0';i++)
+    {
+        if(tuneTextLength>=TUNE_TEXT_SIZE-1)
+        {
+            putsUart0("Tune full\r\n");
+            return;
+        }
+        tuneText[tuneTextLength++]=line[i];
+    }
+}
 
+void appendScriptLine(const char* line)
+{
+    char* text=(char*)&scriptBuffer[2];
+    uint32_t length=scriptBuffer[1];
+    uint8_t i=0;
+    if(stringCompare(line,"end")==0)
+    {
+        scriptUploading=false;
+        saveScript();
+        return;
+    }
+    while(line[i]!='\0')
+        i++;
+    if(length+i+1>SCRIPT_MAX_CHARS)
+    {
+        putsUart0("Script full\r\n");
+        return;
+    }
+    for(i=0;line[i]!='\0';i++)
+        text[length++]=line[i];
+    text[length++]='\n';
+    scriptBuffer[1]=length;
+}
 
-    while(true)
+// Runs the script stored in flash, one line at a time
+void runScript()
+{
+    const uint32_t* stored=(const uint32_t*)SCRIPT_ADDRESS;
+    const char* text=(const char*)&stored[2];
+    char line[MAX_CHARS+1];
+    uint32_t length;
+    uint32_t i=0;
+    uint8_t count;
+    if(stored[0]!=SCRIPT_MAGIC || stored[1]>SCRIPT_MAX_CHARS || scriptRunning)
+        return;
+    length=stored[1];
+    scriptRunning=true;
+    while(i<length)
     {
-        if(kbhitUart0()==true)
+        count=0;
+        while(i<length && text[i]!='\n')
         {
-            getsUart0(&data);
-            putsUart0(data.buffer);
-            putcUart0('\n');
+            if(count<MAX_CHARS)
+                line[count++]=text[i];
+            i++;
+        }
+        line[count]='\0';
+        i++;
+        if(count>0)
+            executeLine(line);
+    }
+    scriptRunning=false;
+}
+
+void showScript()
+{
+    const uint32_t* stored=(const uint32_t*)SCRIPT_ADDRESS;
+    const char* text=(const char*)&stored[2];
+    uint32_t i;
+    if(stored[0]!=SCRIPT_MAGIC || stored[1]>SCRIPT_MAX_CHARS)
+    {
+        putsUart0("No script stored\r\n");
+        return;
+    }
+    for(i=0;i<stored[1];i++)
+    {
+        if(text[i]=='\n')
             putcUart0('\r');
+        putcUart0(text[i]);
+    }
+}
 
-            parseFields(&data);
+void printDate()
+{
+    char string[40];
+    DATE date;
+    uint32_t seconds;
+    getDate(&date);
+    seconds=getSecondOfDay();
+    sprintf(string,"Date: %04u-%02u-%02u %s %02u:%02u:%02u\r\n",date.year,date.month,date.day,
+            getDayName(date.dayOfWeek),seconds/3600,(seconds/60)%60,seconds%60);
+    putsUart0(string);
+}
 
-            uint8_t i;
-            for (i = 0; i < data.fieldCount; i++)
-            {
-                putcUart0(data.fieldType[i]);
-                putcUart0('\t');
-                putsUart0(&data.buffer[data.fieldPosition[i]]);
-                putsUart0("\n\r");
-            }
+void printSchedule()
+{
+    char string[60];
+    SCHEDULE_WINDOW window;
+    uint8_t i;
+    for(i=0;getScheduleWindow(i,&window);i++)
+    {
+        sprintf(string,"Watering Window = %02u:%02u-%02u:%02u days %02X\r\n",window.start/60,window.start%60,window.end/60,window.end%60,window.days);
+        putsUart0(string);
+    }
+    if(i==0)
+        putsUart0("No watering windows\r\n");
+}
 
-            bool valid = false;
-            volume=0;
+const char* zoneStateNames[]={"",", waiting",", watering",", soaking"};
 
+void printZones()
+{
+    char string[100];
+    uint8_t zone;
+    for(zone=0;zone<NUM_ZONES;zone++)
+    {
+        sprintf(string,"Zone %u: moisture %.1f%%, level %u%%, target %u%%, windows %02X%s\r\n",zone,getMoistureReading(zone,CONSOLE_MAX_AGE_MS),
+                zoneLevel[zone],zoneTarget[zone],zoneWindows[zone],zoneStateNames[zoneState[zone]]);
+        putsUart0(string);
+        sprintf(string,"        gain %.3f %%/s, settle %u s, %u cycles\r\n",
+                getWateringGain(zone),getSettleMs(zone)/1000,getWateringCycles(zone));
+        putsUart0(string);
+    }
+    sprintf(string,"Dispatch: %u of %u valves, %u mL committed, longest wait %u s (bound %u s)\r\n",getOpenValveCount(),
+            MAX_ACTIVE_ZONES,getCommittedMl(getTicks()),getLongestWait()/1000,2*MAX_WAIT_MS/1000);
+    putsUart0(string);
+}
 
-            if (isCommand(&data, "alert", 1))
-            {
-                light_level = getFieldInteger(&data,1);
-
-                if(getLightPercentage()>=light_level && getVolume()<200)
-                {
-                    playWaterLowAlert();
-                    valid=true;
-                }
-                if(getLightPercentage()>=light_level && getBatteryVoltage()<4)
-                {
-                    waitMicrosecond(1000000);
-                    playBatteryLowAlert();
-                    valid=true;
-                }
-                else
-                {
-                    valid=true;
-                    continue;
-                }
+void printRtcTime(const char* label, uint64_t time)
+{
+    char string[60];
+    sprintf(string,"%s = %u.%03u sec\r\n",label,RTC_SECONDS(time),RTC_MILLISECONDS(time));
+    putsUart0(string);
+}
 
+void executeCommand(USER_DATA* data)
+{
+    char string[100];
+    uint32_t volume;
+    float light;
+    float BatteryLevel;
+    bool watering;
+    bool valid = false;
+    uint8_t command = findCommand(data);
 
+    if (command==ALERT_COMMAND)
+    {
+        light_level = getFieldInteger(data,1);
+        updateAlerts(getVolumeReading(CONSOLE_MAX_AGE_MS),getBatteryReading(CONSOLE_MAX_AGE_MS),getLightReading(CONSOLE_MAX_AGE_MS));
+        valid=true;
+    }
+
+    // ack silences one active alert (or all) until its condition clears
+    if(command==ACK_COMMAND)
+    {
+        uint8_t alert=ALL_ALERTS;
+        if(data->fieldCount>=2)
+        {
+            alert=findAlert(getFieldString(data,1));
+            if(alert==NO_ALERT)
+            {
+                putsUart0("Unknown alert\r\n");
+                return;
             }
+        }
+        if(!acknowledgeAlert(alert))
+            putsUart0("No active alert\r\n");
+        valid=true;
+    }
 
-            if(isCommand(&data,"status",0))
+    if(command==ALERTS_COMMAND)
+    {
+        ALERT_INFO info;
+        uint8_t alert;
+        for(alert=0;alert<MAX_ALERTS;alert++)
+        {
+            if(!getAlertInfo(alert,&info))
+                continue;
+            sprintf(string,"%-8s %-12s plays %u",info.name,
+                    !info.active ? "clear" : info.acknowledged ? "acknowledged" : "active",info.plays);
+            putsUart0(string);
+            if(info.secondsSincePlay!=0xFFFFFFFF)
             {
-                volume = getVolume();
-                sprintf(string,"Volume = %u mL\r\n",volume);
+                sprintf(string,"\tlast %u s ago",info.secondsSincePlay);
                 putsUart0(string);
+            }
+            putsUart0("\r\n");
+        }
+        valid=true;
+    }
 
-                light= getLightPercentage();
-                sprintf(string,"Light Percentage: %.2f percent\r\n",light);
-                putsUart0(string);
+    if(command==STATUS_COMMAND)
+    {
+        volume = getVolumeReading(CONSOLE_MAX_AGE_MS);
+        sprintf(string,"Volume = %u mL (%u ms old)\r\n",volume,getSnapshotAge(SNAPSHOT_VOLUME));
+        putsUart0(string);
 
-                moisture= getMoisturePercentage();
-                sprintf(string,"Moisture Percentage: %.2f percent\r\n",moisture);
-                putsUart0(string);
+        light= getLightReading(CONSOLE_MAX_AGE_MS);
+        sprintf(string,"Light Percentage: %.2f percent (%u ms old)\r\n",light,getSnapshotAge(SNAPSHOT_LIGHT));
+        putsUart0(string);
 
+        BatteryLevel= getBatteryReading(CONSOLE_MAX_AGE_MS);
+        sprintf(string,"Battery Voltage: %1.2f Volts (%u ms old)\r\n",BatteryLevel,getSnapshotAge(SNAPSHOT_BATTERY));
+        putsUart0(string);
+        sprintf(string,"Sensor cache: %u hits, %u reads\r\n",getSnapshotHits(),getSnapshotReads());
+        putsUart0(string);
 
-                BatteryLevel= getBatteryVoltage();
-                sprintf(string,"Battery Voltage: %1.2f Volts\r\n",BatteryLevel);
-                putsUart0(string);
+        printDate();
 
-                seconds_day = getCurrentSeconds();
-                sprintf(string,"Current Seconds = %d sec\r\n",seconds_day);
-                putsUart0(string);
+        printRtcTime("RTC Time",getRtcTime());
+        printRtcTime("Last Reading",lastReadingTime);
+        printRtcTime("Last Pump",lastPumpTime);
+        printRtcTime("Last Alert",lastAlertTime);
+        sprintf(string,"RTC Drift: %.2f ppm (trim 0x%04X)\r\n",getRtcDriftPpm(),getRtcTrim());
+        putsUart0(string);
 
-                sprintf(string,"Watering Window = %d sec\t%d sec\r\n",lowerWindow,upperWindow);
-                putsUart0(string);
+        printSchedule();
 
-                valid =true;
-            }
+        sprintf(string,"Pump: %s, duty %u.%u%% (run %u.%u%%), flow %.1f mL/s, ramp %u ms\r\n",isPumpOn() ? "on" : "off",
+                getPumpDuty()/10,getPumpDuty()%10,getPumpRunDuty()/10,getPumpRunDuty()%10,getPumpFlow(),getPumpRamp());
+        putsUart0(string);
+        sprintf(string,"Pump safety: max run %u s, %u forced shutdowns%s\r\n",getPumpMaxRun()/1000,getPumpShutdowns(),
+                pumpFault ? ", watering stopped (pump clear)" : "");
+        putsUart0(string);
 
-            if(isCommand(&data,"pump",0))
-            {
-                char *pump = getFieldString(&data,1);
-                if(stringCompare(pump,"ON")==0)
-                {
-                    enablePump();
-                    valid=true;
-                }
-                else if(stringCompare(pump,"OFF")==0)
-                {
-                    disablePump();
-                    valid=true;
-                }
-                else
-                {
-                    putsUart0("Invalid command\n\r");
-                    continue;
-                }
+        printZones();
 
-            }
+        valid =true;
+    }
 
-            if(isCommand(&data,"time",2))
-            {
-                int hours=getFieldInteger(&data,1);
-                int minutes=getFieldInteger(&data,2);
+    if(command==PUMP_COMMAND)
+    {
+        char *pump = getFieldString(data,1);
+        // pump ON [zone] opens the zone valve, zone 0 by default
+        if(stringCompare(pump,"ON")==0 && getFieldInteger(data,2)<NUM_ZONES)
+        {
+            openZone(getFieldInteger(data,2));
+            valid=true;
+        }
+        else if(stringCompare(pump,"OFF")==0)
+        {
+            if(dosing)
+                finishDose("stopped");
+            closeAllValves();
+            disablePump();
+            valid=true;
+        }
+        // pump duty %, pump flow mL/s, pump ramp ms, pump cal mL/s at full duty
+        else if(stringCompare(pump,"duty")==0 && setPumpDuty(getFieldInteger(data,2)*10))
+        {
+            resumeTask(pumpTask);
+            valid=true;
+        }
+        else if(stringCompare(pump,"flow")==0 && setPumpFlow(getFieldInteger(data,2)))
+        {
+            resumeTask(pumpTask);
+            valid=true;
+        }
+        else if(stringCompare(pump,"ramp")==0 && data->fieldCount>=3)
+        {
+            setPumpRamp(getFieldInteger(data,2));
+            valid=true;
+        }
+        else if(stringCompare(pump,"cal")==0 && getFieldInteger(data,2)>0)
+        {
+            setPumpFullFlow(getFieldInteger(data,2));
+            valid=true;
+        }
+        // pump max s, the safety timer's limit on one run
+        else if(stringCompare(pump,"max")==0 && getFieldInteger(data,2)<=getPumpMaxRunLimit()/1000
+                && setPumpMaxRun(getFieldInteger(data,2)*1000))
+        {
+            valid=true;
+        }
+        // pump clear lets watering start again after a safety cutoff
+        else if(stringCompare(pump,"clear")==0)
+        {
+            pumpFault=false;
+            valid=true;
+        }
+        else
+        {
+            putsUart0("Invalid command\n\r");
+            return;
+        }
 
-                HIB_RTCLD_R= (minutes*60)+(hours*60*60);
-                valid=true;
+    }
 
-            }
+    if(command==TIME_COMMAND)
+    {
+        uint32_t hours=getFieldInteger(data,1);
+        uint32_t minutes=getFieldInteger(data,2);
 
-            if(isCommand(&data,"water",4))
-            {
-                int hours1=getFieldInteger(&data,1);
-                int minutes1=getFieldInteger(&data,2);
-                int hours2=getFieldInteger(&data,3);
-                int minutes2=getFieldInteger(&data,4);
-
-                lowerWindow=(minutes1*60)+(hours1*60*60);
-                upperWindow=(minutes2*60)+(hours2*60*60);
-                watering=isWateringAllowed(lowerWindow,upperWindow);
-                if(watering==true)
-                {
-                    sprintf(string,"Watering is Allowed");
-                    putsUart0(string);
-                }
-                else
-                {
-                    sprintf(string,"Watering is not Allowed");
-                    putsUart0(string);
-                }
-                valid=true;
+        if(!setTimeOfDay(hours,minutes,0))
+        {
+            putsUart0("Invalid time\r\n");
+            return;
+        }
+        valid=true;
 
-            }
+    }
 
-            if(isCommand(&data,"level",1))
+    // volume 0-100 sets the speaker duty cycle
+    if(command==VOLUME_COMMAND)
+    {
+        setMelodyVolume(getFieldInteger(data,1));
+        valid=true;
+    }
+
+    // date prints the date, date yyyy mm dd sets it and keeps the time
+    if(command==DATE_COMMAND)
+    {
+        if(data->fieldCount>=4)
+        {
+            if(!setDate(getFieldInteger(data,1),getFieldInteger(data,2),getFieldInteger(data,3)))
             {
-                level= getFieldInteger(&data,1);
-                valid=true;
+                putsUart0("Invalid date\r\n");
+                return;
             }
+        }
+        printDate();
+        valid=true;
+    }
 
+    // sync <unix seconds> from the host, repeated a day or more apart to
+    // measure the crystal drift
+    if(command==SYNC_COMMAND)
+    {
+        char string[60];
+        RTC_SYNC_RESULT result=syncRtc((uint32_t)getFieldInteger(data,1));
+        if(result==RTC_SYNC_STARTED)
+            putsUart0("RTC set, sync again later to measure drift\r\n");
+        else if(result==RTC_SYNC_TOO_SOON)
+            putsUart0("Too soon since last sync, RTC not changed\r\n");
+        else if(result==RTC_SYNC_REJECTED)
+            putsUart0("Error too large for drift, RTC set\r\n");
+        else
+        {
+            sprintf(string,"RTC drift %.2f ppm, trim 0x%04X\r\n",getRtcDriftPpm(),getRtcTrim());
+            putsUart0(string);
+        }
+        valid=true;
+    }
 
-            if (!valid)
+    if(command==WATER_COMMAND)
+    {
+        uint32_t hours1=getFieldInteger(data,1);
+        uint32_t minutes1=getFieldInteger(data,2);
+        uint32_t hours2=getFieldInteger(data,3);
+        uint32_t minutes2=getFieldInteger(data,4);
+        uint32_t saved[MAX_SCHEDULE_WINDOWS];
+        uint8_t count=getScheduleWindowCount();
+        uint8_t i;
+
+        // The old windows are only replaced by a window that is valid
+        if(hours1<24 && minutes1<60 && hours2<24 && minutes2<60)
+        {
+            for(i=0;i<count;i++)
+                saved[i]=packScheduleWindow(i);
+            clearSchedule();
+            if(addScheduleWindow(hours1*60+minutes1,hours2*60+minutes2,ALL_DAYS))
+                valid=true;
+            else
+            {
+                for(i=0;i<count;i++)
+                    addPackedScheduleWindow(saved[i]);
+            }
+        }
+        if(valid)
+        {
+            watering=isWateringAllowed();
+            if(watering==true)
+            {
+                sprintf(string,"Watering is Allowed");
+                putsUart0(string);
+            }
+            else
             {
-                putsUart0("Invalid command\n\r");
+                sprintf(string,"Watering is not Allowed");
+                putsUart0(string);
             }
         }
         else
         {
-            volume = getVolume();
-            light= getLightPercentage();
-            moisture= getMoisturePercentage();
-            BatteryLevel= getBatteryVoltage();
-            seconds_day = getCurrentSeconds();
+            putsUart0("Invalid time\r\n");
+            valid=true;
+        }
+
+    }
+
+    // window h1 m1 h2 m2 [days] adds a window, days is a bit mask with
+    // Sunday as bit 0 (default every day); "window clear" removes them all
+    if(command==WINDOW_COMMAND)
+    {
+        if(data->fieldType[1]=='n' && data->fieldCount>=5)
+        {
+            uint8_t days=ALL_DAYS;
+            if(data->fieldCount>=6)
+                days=getFieldInteger(data,5);
+            if(getFieldInteger(data,1)<24 && getFieldInteger(data,2)<60 && getFieldInteger(data,3)<24 && getFieldInteger(data,4)<60
+               && addScheduleWindow(getFieldInteger(data,1)*60+getFieldInteger(data,2),getFieldInteger(data,3)*60+getFieldInteger(data,4),days))
+                valid=true;
+        }
+        else if(stringCompare(getFieldString(data,1),"clear")==0)
+        {
+            clearSchedule();
+            valid=true;
+        }
+        else if(stringCompare(getFieldString(data,1),"list")==0)
+        {
+            printSchedule();
+            valid=true;
+        }
+    }
 
+    // dose <mL> [zone] runs the pump until the reservoir has dropped by mL
+    if(command==DOSE_COMMAND)
+    {
+        if(stringCompare(getFieldString(data,1),"stop")==0)
+        {
+            if(dosing)
+                finishDose("stopped");
+        }
+        else if(!startDose(getFieldInteger(data,1),getFieldInteger(data,2)))
+        {
+            putsUart0("Can not dose now\r\n");
+            return;
+        }
+        valid=true;
+    }
+
+    // level and target apply to every zone, zone <n> sets one zone
+    if(command==LEVEL_COMMAND)
+    {
+        uint32_t level=getFieldInteger(data,1);
+        uint8_t zone;
+        if(level>MAX_PERCENT)
+        {
+            putsUart0("Invalid level\r\n");
+            return;
+        }
+        for(zone=0;zone<NUM_ZONES;zone++)
+            zoneLevel[zone]=level;
+        valid=true;
+    }
 
-            if(light>=light_level && volume<200)
+    // target sets the moisture watering stops at, target reset forgets
+    // what the controller has learned about the soil
+    if(command==TARGET_COMMAND)
+    {
+        uint32_t target=getFieldInteger(data,1);
+        bool reset=stringCompare(getFieldString(data,1),"reset")==0;
+        uint8_t zone;
+        if(!reset && target>MAX_PERCENT)
+        {
+            putsUart0("Invalid target\r\n");
+            return;
+        }
+        for(zone=0;zone<NUM_ZONES;zone++)
+        {
+            if(reset)
+                resetWateringModel(zone);
+            else
+                zoneTarget[zone]=target;
+        }
+        valid=true;
+    }
+
+    if(command==ZONES_COMMAND)
+    {
+        printZones();
+        valid=true;
+    }
+
+    // zone <n> level|target <%>, zone <n> windows <mask> (bit n for window
+    // n), zone <n> reset, zone save writes the zone settings to flash
+    if(command==ZONE_COMMAND)
+    {
+        uint32_t zone=getFieldInteger(data,1);
+        uint32_t value=getFieldInteger(data,3);
+        char *field=getFieldString(data,2);
+        if(stringCompare(getFieldString(data,1),"save")==0)
+        {
+            if(!saveZones())
+                putsUart0("Zone save failed\r\n");
+            valid=true;
+        }
+        else if(data->fieldType[1]!='n' || zone>=NUM_ZONES)
+        {
+            putsUart0("Invalid zone\r\n");
+            return;
+        }
+        else if(stringCompare(field,"reset")==0)
+        {
+            resetWateringModel(zone);
+            valid=true;
+        }
+        else if(data->fieldCount>=4)
+        {
+            if(stringCompare(field,"level")==0 && value<=MAX_PERCENT)
             {
-                playWaterLowAlert();
-                waitMicrosecond(10000000);
+                zoneLevel[zone]=value;
+                valid=true;
             }
-            if(light>=light_level && BatteryLevel<4)
+            else if(stringCompare(field,"target")==0 && value<=MAX_PERCENT)
             {
-                playBatteryLowAlert();
-                waitMicrosecond(10000000);
+                zoneTarget[zone]=value;
+                valid=true;
             }
-            watering=isWateringAllowed(lowerWindow,upperWindow);
-            if(moisture<level && watering==true && volume>200)
+            else if(stringCompare(field,"windows")==0)
             {
-                while(moisture<=60 && volume>200)
-                {
-                    enablePump();
-                    waitMicrosecond(5000000);
-                    disablePump();
-                    waitMicrosecond(30000000);
-                    moisture=getMoisturePercentage();
-                    volume= getVolume();
-                }
+                zoneWindows[zone]=value & ALL_WINDOWS;
+                valid=true;
             }
+        }
+    }
 
+    if(command==SCRIPT_COMMAND)
+    {
+        char *mode = getFieldString(data,1);
+        if(stringCompare(mode,"begin")==0)
+        {
+            scriptUploading=true;
+            scriptBuffer[1]=0;
+            putsUart0("Enter commands, finish with end\r\n");
+            valid=true;
+        }
+        else if(stringCompare(mode,"run")==0)
+        {
+            runScript();
+            valid=true;
+        }
+        else if(stringCompare(mode,"show")==0)
+        {
+            showScript();
+            valid=true;
+        }
+        else if(stringCompare(mode,"clear")==0)
+        {
+            eraseFlashPage(SCRIPT_ADDRESS);
+            valid=true;
         }
     }
 
+
+    // tune water|battery begin|play|clear
+    if(command==TUNE_COMMAND)
+    {
+        char *name = getFieldString(data,1);
+        char *mode = getFieldString(data,2);
+        int8_t slot=NO_TUNE_UPLOAD;
+        if(stringCompare(name,"water")==0)
+            slot=WATER_LOW_TUNE;
+        else if(stringCompare(name,"battery")==0)
+            slot=BATTERY_LOW_TUNE;
+        if(slot!=NO_TUNE_UPLOAD && stringCompare(mode,"begin")==0)
+        {
+            tuneUploadSlot=slot;
+            tuneTextLength=0;
+            putsUart0("Enter RTTTL, finish with end\r\n");
+            valid=true;
+        }
+        else if(slot!=NO_TUNE_UPLOAD && stringCompare(mode,"play")==0)
+        {
+            playTune(&alertTunes[slot]);
+            valid=true;
+        }
+        else if(slot!=NO_TUNE_UPLOAD && stringCompare(mode,"clear")==0)
+        {
+            memcpy(tunePage,(const void*)TUNE_ADDRESS,FLASH_PAGE_SIZE);
+            writeTuneSlot(slot,0);
+            valid=true;
+        }
+    }
+
+    if(command==TASKS_COMMAND)
+    {
+        TASK_INFO info;
+        KERNEL_STATS stats;
+        uint8_t task;
+        for(task=0;getTaskInfo(task,&info);task++)
+        {
+            sprintf(string,"%-10s pri %u %-8s runs %u\tmax %u us\tstack %u/%u\r\n",info.name,info.priority,
+                    info.blocked ? "blocked" : info.suspended ? "waiting" : info.ready ? "ready" : "sleeping",info.runs,
+                    cyclesToMicroseconds(info.maxCycles),info.stackUsed,info.stackSize);
+            putsUart0(string);
+        }
+        getKernelStats(&stats);
+        sprintf(string,"Switches %u\tpreemptions %u\tidle %u\tmax ready %u\r\n",stats.switches,stats.preemptions,stats.idleEntries,stats.maxReady);
+        putsUart0(string);
+        valid=true;
+    }
+
+    if(command==POWER_COMMAND)
+    {
+        KERNEL_STATS stats;
+        getKernelStats(&stats);
+        sprintf(string,"Wakes %u\tasleep %u of %u ms\r\n",stats.wakes,stats.sleepTicks,getTicks());
+        putsUart0(string);
+        sprintf(string,"Average current %u.%u mA (estimated)\r\n",stats.averageCurrent/1000,(stats.averageCurrent%1000)/100);
+        putsUart0(string);
+        sprintf(string,"Battery Voltage: %1.2f Volts\r\n",getBatteryReading(CONSOLE_MAX_AGE_MS));
+        putsUart0(string);
+        valid=true;
+    }
+
+    if(command==DEEPSLEEP_COMMAND)
+    {
+        deepSleepMinutes=getFieldInteger(data,1);
+        valid=true;
+    }
+
+    if(command==VERBOSE_COMMAND)
+    {
+        char *mode = getFieldString(data,1);
+        if(stringCompare(mode,"quiet")==0)
+        {
+            verbosity=VERBOSITY_QUIET;
+            valid=true;
+        }
+        else if(stringCompare(mode,"normal")==0)
+        {
+            verbosity=VERBOSITY_NORMAL;
+            valid=true;
+        }
+#ifndef NDEBUG
+        else if(stringCompare(mode,"debug")==0)
+        {
+            verbosity=VERBOSITY_DEBUG;
+            valid=true;
+        }
+#endif
+    }
+
+
+    if (!valid)
+    {
+        putsUart0("Invalid command\n\r");
+    }
+}
+
+// Splits a line on ';' and executes each command in turn
+void executeLine(const char* line)
+{
+    USER_DATA data;
+#ifndef NDEBUG
+    uint8_t j;
+#endif
+    do
+    {
+        line=splitLine(line,&data);
+
+#ifndef NDEBUG
+        if(verbosity>=VERBOSITY_DEBUG)
+        {
+            for (j = 0; j < data.fieldCount; j++)
+            {
+                putcUart0(data.fieldType[j]);
+                putcUart0('\t');
+                putsUart0(&data.buffer[data.fieldPosition[j]]);
+                putsUart0("\n\r");
+            }
+        }
+#endif
+
+        executeCommand(&data);
+    } while(*line!='\0');
+}
+
+// Waits for a line, then handles it holding controlLock so the control
+// tasks see each command as one step
+void consoleTask()
+{
+    getsUart0(&consoleData);                        // blocks on the receive queue
+    lastConsoleTick=getTicks();
+    wokeFromHibernate=false;                        // someone is there, keep the quiet window
+    waitSemaphore(&controlLock);
+    if(scriptUploading)
+    {
+        appendScriptLine(consoleData.buffer);
+    }
+    else if(tuneUploadSlot!=NO_TUNE_UPLOAD)
+    {
+        appendTuneLine(consoleData.buffer);
+    }
+    else
+    {
+        if(verbosity>=VERBOSITY_NORMAL)
+        {
+            putsUart0(consoleData.buffer);
+            putcUart0('\n');
+            putcUart0('\r');
+        }
+        executeLine(consoleData.buffer);
+    }
+    postSemaphore(&controlLock);
+}
+
+// Queues the zone for its next pulse, false once its windows have closed
+// or it has had all its pulses
+bool queueZone(uint8_t zone,float moisture)
+{
+    uint16_t minutes=getMinutesToClose(zoneWindows[zone],getMinuteOfWeek());
+    if(minutes==0 || zonePulses[zone]>=MAX_WATERING_PULSES)
+        return false;
+    requestWatering(zone,zoneTarget[zone]-moisture,minutes,getTicks());
+    zoneState[zone]=WATERING_WAIT;
+    return true;
+}
+
+// One zone's watering from the first request to the last soak.  The wait
+// for the dispatcher ends when dispatchZones starts the pulse or the
+// request is dropped, which both call the flow at once
+void runZoneFlow(uint8_t zone)
+{
+    COROUTINE* co=&zoneFlow[zone];
+    CO_BEGIN(co);
+    while(queueZone(zone,getMoistureReading(zone,MONITOR_PERIOD_MS)))
+    {
+        CO_AWAIT(co,zoneState[zone]!=WATERING_WAIT);
+        if(zoneState[zone]!=WATERING_PULSE)
+            break;                                  // dropped at its deadline or already wet
+        CO_SLEEP(co,zonePulseMs[zone]);
+        closeZone(zone);
+        zoneState[zone]=WATERING_SOAK;
+        zoneSoakStart[zone]=getTicks();
+        zoneSoakMs[zone]=startSoak(zone,zonePulseMoisture[zone],endPulse(zone,zoneSoakStart[zone]));
+        while(zoneSoakMs[zone]>0)
+        {
+            CO_SLEEP(co,zoneSoakMs[zone]);
+            zoneSoakMs[zone]=updateSoak(zone,getMoistureReading(zone,SOAK_MAX_AGE_MS),getTicks()-zoneSoakStart[zone]);
+        }
+    }
+    zoneState[zone]=WATERING_IDLE;
+    CO_END(co);
+}
+
+// After a safety cutoff the valves are closed and every zone flow is
+// dropped, so nothing waits on a pump that is off
+void checkPumpCutoff()
+{
+    uint8_t zone;
+    if(getPumpShutdowns()==pumpShutdownsSeen)
+        return;
+    pumpShutdownsSeen=getPumpShutdowns();
+    pumpFault=true;
+    closeAllValves();
+    for(zone=0;zone<NUM_ZONES;zone++)
+    {
+        if(zoneState[zone]==WATERING_IDLE)
+            continue;
+        cancelWatering(zone);
+        endPulse(zone,getTicks());
+        zoneState[zone]=WATERING_IDLE;
+        startCoroutine(&zoneFlow[zone]);
+    }
+    invalidateSnapshot(SNAPSHOT_VOLUME);
+    putsUart0("Pump safety cutoff, watering stopped until pump clear\r\n");
+}
+
+// Reads the sensors, raises alerts and starts watering the zones that are
+// below their level while one of their windows is open
+void monitorTask()
+{
+    uint32_t volume = getVolumeReading(MONITOR_MAX_AGE_MS);
+    float light= getLightReading(MONITOR_MAX_AGE_MS);
+    float BatteryLevel= getBatteryReading(MONITOR_MAX_AGE_MS);
+    uint8_t open=getOpenWindows(getMinuteOfWeek());
+    uint8_t zone;
+    lastReadingTime=getRtcTime();
+
+    checkPumpCutoff();
+    updateAlerts(volume,BatteryLevel,light);
+    for(zone=0;zone<NUM_ZONES;zone++)
+    {
+        if(zoneState[zone]==WATERING_IDLE && getMoistureReading(zone,MONITOR_MAX_AGE_MS)<zoneLevel[zone] && (zoneWindows[zone] & open)
+           && volume>MIN_RESERVOIR_ML && !dosing && !pumpFault)
+        {
+            zonePulses[zone]=0;
+            startCoroutine(&zoneFlow[zone]);
+            runZoneFlow(zone);
+            resumeTask(wateringTask);
+        }
+    }
+    checkDeepSleep();
+    sleepTask(MONITOR_PERIOD_MS);
+}
+
+// Tracks the reservoir drawdown while a dose runs
+void doseTask()
+{
+    uint32_t volume;
+    if(!dosing)
+    {
+        suspendTask();                              // startDose resumes it
+        return;
+    }
+    volume=getVolumeReading(DOSE_MAX_AGE_MS);
+    if(doseStartVolume>volume && doseStartVolume-volume>doseDelivered)
+    {
+        doseDelivered=doseStartVolume-volume;
+        doseProgressTick=getTicks();
+    }
+    if(doseDelivered>=doseTarget)
+        finishDose("done");
+    else if(!isPumpOn())
+        finishDose("safety cutoff");
+    else if(volume<=MIN_RESERVOIR_ML)
+        finishDose("reservoir empty");
+    else if(getTicks()-doseProgressTick>=DOSE_STALL_MS)
+        finishDose("no flow");
+    else if(getTicks()-doseStartTick>=doseTimeoutMs)
+        finishDose("timeout");
+    else
+        sleepTask(DOSE_SAMPLE_MS);
+}
+
+// Steps the pump soft start ramp
+void pumpTask()
+{
+    if(updatePump())
+        sleepTask(PUMP_RAMP_STEP_MS);
+    else
+        suspendTask();                              // enablePump resumes it
+}
+
+// Starts the most urgent waiting zones while a valve is free and the
+// reservoir above its reserve can cover the pulse
+void dispatchZones(uint32_t now)
+{
+    uint32_t volume, spare, ms;
+    uint8_t zone;
+    if(getOpenValveCount()>=MAX_ACTIVE_ZONES || getNextRequest(now)==NO_ZONE)
+        return;
+    volume=getVolumeReading(DISPATCH_MAX_AGE_MS);
+    spare=volume>MIN_RESERVOIR_ML ? volume-MIN_RESERVOIR_ML : 0;
+    while(getOpenValveCount()<MAX_ACTIVE_ZONES && (zone=getNextRequest(now))!=NO_ZONE)
+    {
+        zonePulseMoisture[zone]=getMoistureReading(zone,DISPATCH_MAX_AGE_MS);
+        ms=getPulseMs(zone,zonePulseMoisture[zone],zoneTarget[zone]);
+        if(ms==0)
+        {
+            cancelWatering(zone);
+            zoneState[zone]=WATERING_IDLE;
+            runZoneFlow(zone);
+            continue;
+        }
+        ms=fitPulse(ms,getPumpFlow(),spare,now);
+        if(ms==0)
+            return;                                 // no smaller pulse may overtake this zone
+        zonePulseMs[zone]=ms;
+        startPulse(zone,ms,getPumpFlow(),now);
+        openZone(zone);
+        lastPumpTime=getRtcTime();
+        zonePulses[zone]++;
+        zoneState[zone]=WATERING_PULSE;
+        runZoneFlow(zone);
+    }
+}
+
+// Runs the zone flows whose sleep is over and starts waiting zones
+// Sleeps until the next flow is due, at most a monitor period so waiting
+// zones are dispatched as the reservoir allows
+void wateringTask()
+{
+    uint32_t now=getTicks();
+    uint32_t sleep=MONITOR_PERIOD_MS;
+    uint8_t expired;
+    bool busy=false;
+    int32_t delta;
+    uint8_t zone;
+    for(zone=0;zone<NUM_ZONES;zone++)
+        if(zoneState[zone]!=WATERING_IDLE && isCoroutineDue(&zoneFlow[zone],now))
+            runZoneFlow(zone);
+    expired=takeExpiredRequests(now);
+    for(zone=0;zone<NUM_ZONES;zone++)
+    {
+        if(expired & (1 << zone))
+        {
+            zoneState[zone]=WATERING_IDLE;
+            runZoneFlow(zone);
+        }
+    }
+    dispatchZones(now);
+    for(zone=0;zone<NUM_ZONES;zone++)
+    {
+        if(zoneState[zone]==WATERING_IDLE)
+            continue;
+        busy=true;
+        if(!zoneFlow[zone].timed)
+            continue;
+        delta=(int32_t)(zoneFlow[zone].wakeTick-now);
+        if(delta<=0)
+            sleep=0;
+        else if((uint32_t)delta<sleep)
+            sleep=delta;
+    }
+    if(busy)
+        sleepTask(sleep);
+    else
+        suspendTask();                              // monitorTask resumes it
+}
+
+int main()
+{
+    initHw();
+    initHibernate();
+    initRtc();
+    initPwm();
+    initPump();
+    initZones();
+    initMelody();
+    loadAlertTunes();
+    defineAlert(WATER_LOW_ALERT,"water",WATER_LOW_PRIORITY,WATER_LOW_COOLDOWN_S,&alertTunes[WATER_LOW_TUNE]);
+    defineAlert(BATTERY_LOW_ALERT,"battery",BATTERY_LOW_PRIORITY,BATTERY_LOW_COOLDOWN_S,&alertTunes[BATTERY_LOW_TUNE]);
+    initUart0();
+    initAdc0Ss3();
+    initKernel();
+    initSemaphore(&controlLock,1,CONTROL_PRIORITY);
+
+    addScheduleWindow(12*60,17*60,ALL_DAYS);
+    loadZones();
+
+    // After a deep sleep wake the saved configuration is used as is,
+    // otherwise the boot script sets it up
+    wokeFromHibernate=restoreControllerState();
+    if(!wokeFromHibernate)
+        runScript();
+
+    createTask(consoleTask,"console",CONSOLE_PRIORITY,consoleStack,CONSOLE_STACK_WORDS);
+    createTask(monitorTask,"monitor",CONTROL_PRIORITY,monitorStack,MONITOR_STACK_WORDS);
+    createTask(wateringTask,"watering",CONTROL_PRIORITY,wateringStack,WATERING_STACK_WORDS);
+    createTask(pumpTask,"pump",PUMP_PRIORITY,pumpStack,PUMP_STACK_WORDS);
+    createTask(doseTask,"dose",CONTROL_PRIORITY,doseStack,DOSE_STACK_WORDS);
+    startKernel();
 }
@@ -0,0 +1,153 @@
+// Watering Controller Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// None
+
+// The soil is modelled by two learned numbers: the gain, how many percent
+// of moisture one second of pumping adds once the water has soaked in, and
+// the settle time, how long that soaking takes.
+//
+// Each pulse is sized from the gain to cover most of the remaining gap to
+// the target (PULSE_FRACTION, so an over-estimated response does not
+// overshoot).  The soak is then watched: the first reading is taken at
+// most of the learned settle time and then every SOAK_SAMPLE_MS until the
+// moisture stops rising.  The observed rise per pump second and the time
+// it took to settle are blended into the model, so later pulses are sized
+// and timed for the way this soil actually responds.
+//
+// Every zone has its own model and soak, kept in one array per field.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "zone.h"
+#include "watering.h"
+
+#define DEFAULT_GAIN 1.0f                       // percent per pump second
+#define MIN_GAIN 0.05f
+#define MAX_GAIN 20.0f
+#define DEFAULT_SETTLE_MS 30000
+#define PULSE_FRACTION 0.8f
+#define LEARNING_RATE 0.3f
+#define SETTLE_DELTA 0.5f                       // percent rise between samples still soaking
+#define MIN_LEARN_RISE 0.5f                     // smaller rises are sensor noise
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+float wateringGain[NUM_ZONES];
+uint32_t settleMs[NUM_ZONES];
+uint32_t wateringCycles[NUM_ZONES];
+float soakStartMoisture[NUM_ZONES];
+float soakLastMoisture[NUM_ZONES];
+uint32_t soakPulseMs[NUM_ZONES];
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void resetWateringModel(uint8_t zone)
+{
+    wateringGain[zone] = DEFAULT_GAIN;
+    settleMs[zone] = DEFAULT_SETTLE_MS;
+    wateringCycles[zone] = 0;
+}
+
+// Pump time for the next pulse, 0 when the target has been reached
+uint32_t getPulseMs(uint8_t zone, float moisture, float target)
+{
+    float ms;
+    if (moisture >= target - WATERING_DEADBAND)
+        return 0;
+    ms = (target - moisture) / wateringGain[zone] * PULSE_FRACTION * 1000;
+    if (ms < MIN_PULSE_MS)
+        return MIN_PULSE_MS;
+    if (ms > MAX_PULSE_MS)
+        return MAX_PULSE_MS;
+    return ms;
+}
+
+// Called when the pump stops with the moisture read before the pulse
+// Returns the time until the first soak reading
+uint32_t startSoak(uint8_t zone, float moisture, uint32_t pulseMs)
+{
+    uint32_t ms = settleMs[zone] * 3 / 4;
+    soakStartMoisture[zone] = moisture;
+    soakLastMoisture[zone] = moisture;
+    soakPulseMs[zone] = pulseMs;
+    if (ms < MIN_SOAK_MS)
+        ms = MIN_SOAK_MS;
+    return ms;
+}
+
+static void learn(uint8_t zone, float moisture, uint32_t elapsedMs)
+{
+    float rise = moisture - soakStartMoisture[zone];
+    float gain;
+    settleMs[zone] += (int32_t)(LEARNING_RATE * ((float)elapsedMs - (float)settleMs[zone]));
+    if (soakPulseMs[zone] == 0)
+        return;                                      // no pump time to learn a gain from
+    if (rise < MIN_LEARN_RISE)
+        gain = MIN_GAIN;                             // water ran off or the sensor is dry
+    else
+        gain = rise * 1000 / soakPulseMs[zone];
+    wateringGain[zone] += LEARNING_RATE * (gain - wateringGain[zone]);
+    if (wateringGain[zone] < MIN_GAIN)
+        wateringGain[zone] = MIN_GAIN;
+    if (wateringGain[zone] > MAX_GAIN)
+        wateringGain[zone] = MAX_GAIN;
+    wateringCycles[zone]++;
+}
+
+// Called with each soak reading and the time since the pump stopped
+// Returns the time until the next reading, or 0 once the soil has settled
+uint32_t updateSoak(uint8_t zone, float moisture, uint32_t elapsedMs)
+{
+    bool settled = moisture - soakLastMoisture[zone] < SETTLE_DELTA && elapsedMs >= MIN_SOAK_MS;
+    soakLastMoisture[zone] = moisture;
+    if (!settled && elapsedMs < MAX_SOAK_MS)
+        return SOAK_SAMPLE_MS;
+    learn(zone, moisture, elapsedMs);
+    return 0;
+}
+
+float getWateringGain(uint8_t zone)
+{
+    return wateringGain[zone];
+}
+
+uint32_t getSettleMs(uint8_t zone)
+{
+    return settleMs[zone];
+}
+
+uint32_t getWateringCycles(uint8_t zone)
+{
+    return wateringCycles[zone];
+}
+
+// Gain in 1/1000 % per second and settle time in 1/10 s, for storage
+uint32_t packWateringModel(uint8_t zone)
+{
+    return ((uint32_t)(wateringGain[zone] * 1000) & 0xFFFF) | ((settleMs[zone] / 100) << 16);
+}
+
+void unpackWateringModel(uint8_t zone, uint32_t packed)
+{
+    wateringGain[zone] = (float)(packed & 0xFFFF) / 1000;
+    settleMs[zone] = (packed >> 16) * 100;
+    if (wateringGain[zone] < MIN_GAIN || wateringGain[zone] > MAX_GAIN || settleMs[zone] == 0)
+        resetWateringModel(zone);
+}
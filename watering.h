@@ -0,0 +1,42 @@
+// Watering Controller Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// None
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef WATERING_H_
+#define WATERING_H_
+
+#define MIN_PULSE_MS 1000
+#define MAX_PULSE_MS 20000
+#define SOAK_SAMPLE_MS 5000
+#define MIN_SOAK_MS 10000
+#define MAX_SOAK_MS 180000
+#define WATERING_DEADBAND 1.0f                  // percent below the target counted as reached
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void resetWateringModel(uint8_t zone);
+uint32_t getPulseMs(uint8_t zone, float moisture, float target);
+uint32_t startSoak(uint8_t zone, float moisture, uint32_t pulseMs);
+uint32_t updateSoak(uint8_t zone, float moisture, uint32_t elapsedMs);
+float getWateringGain(uint8_t zone);
+uint32_t getSettleMs(uint8_t zone);
+uint32_t getWateringCycles(uint8_t zone);
+uint32_t packWateringModel(uint8_t zone);
+void unpackWateringModel(uint8_t zone, uint32_t packed);
+
+#endif
@@ -0,0 +1,119 @@
+// Zone Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// Zone moisture sensors on AIN2 (PE1), AIN0 (PE3), AIN9 (PE4), AIN8 (PE5),
+//   AIN4 (PD3), AIN5 (PD2), AIN6 (PD1), AIN7 (PD0) for zones 0-7
+// Zone valves on PB0, PB1, PB2, PB3, PA2, PA3, PA4, PA5 for zones 0-7
+//   (high opens the valve, all zones share the pump)
+
+// The pin assignments are constant tables in flash, one entry per zone.
+// initZones resolves each valve pin to its bit-band alias once, so opening
+// or closing a valve is a single store.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "adc0.h"
+#include "zone.h"
+
+#define PORTA 0x40004000
+#define PORTB 0x40005000
+#define PORTD 0x40007000
+#define PORTE 0x40024000
+
+#define GPIO_REG(port, offset) (*((volatile uint32_t *)((port) + (offset))))
+#define GPIO_DIR 0x400
+#define GPIO_AFSEL 0x420
+#define GPIO_DEN 0x51C
+#define GPIO_AMSEL 0x528
+#define GPIO_BITBAND(port, pin) ((volatile uint32_t *)(0x42000000 + ((port) + 0x3FC - 0x40000000)*32 + (pin)*4))
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+const uint8_t zoneAdcInput[MAX_ZONES] = {2, 0, 9, 8, 4, 5, 6, 7};
+const uint32_t zoneAdcPort[MAX_ZONES] = {PORTE, PORTE, PORTE, PORTE, PORTD, PORTD, PORTD, PORTD};
+const uint8_t zoneAdcPin[MAX_ZONES] = {1, 3, 4, 5, 3, 2, 1, 0};
+const uint32_t zoneValvePort[MAX_ZONES] = {PORTB, PORTB, PORTB, PORTB, PORTA, PORTA, PORTA, PORTA};
+const uint8_t zoneValvePin[MAX_ZONES] = {0, 1, 2, 3, 2, 3, 4, 5};
+
+volatile uint32_t* zoneValve[NUM_ZONES];
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Analog inputs for the sensors and closed valves for the zones in use
+void initZones()
+{
+    uint8_t zone;
+    uint32_t mask;
+    SYSCTL_RCGCGPIO_R |= SYSCTL_RCGCGPIO_R0 | SYSCTL_RCGCGPIO_R1 | SYSCTL_RCGCGPIO_R3 | SYSCTL_RCGCGPIO_R4;
+    _delay_cycles(3);
+    for (zone = 0; zone < NUM_ZONES; zone++)
+    {
+        mask = 1 << zoneAdcPin[zone];
+        GPIO_REG(zoneAdcPort[zone], GPIO_AFSEL) |= mask;
+        GPIO_REG(zoneAdcPort[zone], GPIO_DEN) &= ~mask;
+        GPIO_REG(zoneAdcPort[zone], GPIO_AMSEL) |= mask;
+
+        mask = 1 << zoneValvePin[zone];
+        zoneValve[zone] = GPIO_BITBAND(zoneValvePort[zone], zoneValvePin[zone]);
+        *zoneValve[zone] = 0;
+        GPIO_REG(zoneValvePort[zone], GPIO_DIR) |= mask;
+        GPIO_REG(zoneValvePort[zone], GPIO_DEN) |= mask;
+    }
+}
+
+// Soil moisture in percent, dry soil reads near the full scale voltage
+float readZoneMoisture(uint8_t zone)
+{
+    float MoisturePercent=0;
+    float rawValue=0;
+    setAdc0Ss3Mux(zoneAdcInput[zone]);
+    setAdc0Ss3Log2AverageCount(4);
+    rawValue= readAdc0Ss3();
+    rawValue= ((rawValue+0.5) / 4096 * 3.3);
+    MoisturePercent= (rawValue/3.264148)*100;
+    MoisturePercent= 100-MoisturePercent;
+    return MoisturePercent;
+}
+
+void setZoneValve(uint8_t zone, bool open)
+{
+    if (zone < NUM_ZONES)
+        *zoneValve[zone] = open;
+}
+
+bool isZoneValveOpen(uint8_t zone)
+{
+    return zone < NUM_ZONES && *zoneValve[zone];
+}
+
+uint8_t getOpenValveCount()
+{
+    uint8_t zone, count = 0;
+    for (zone = 0; zone < NUM_ZONES; zone++)
+        count += *zoneValve[zone];
+    return count;
+}
+
+void closeAllValves()
+{
+    uint8_t zone;
+    for (zone = 0; zone < NUM_ZONES; zone++)
+        *zoneValve[zone] = 0;
+}
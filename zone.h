@@ -0,0 +1,46 @@
+// Zone Library
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// Zone moisture sensors on AIN2 (PE1), AIN0 (PE3), AIN9 (PE4), AIN8 (PE5),
+//   AIN4 (PD3), AIN5 (PD2), AIN6 (PD1), AIN7 (PD0) for zones 0-7
+// Zone valves on PB0, PB1, PB2, PB3, PA2, PA3, PA4, PA5 for zones 0-7
+//   (high opens the valve, all zones share the pump)
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef ZONE_H_
+#define ZONE_H_
+
+#define MAX_ZONES 8                             // zones the board has pins for
+#define NO_ZONE 0xFF
+
+// Zones used by this build, override with -DNUM_ZONES=n
+#ifndef NUM_ZONES
+#define NUM_ZONES 8
+#endif
+#if NUM_ZONES > MAX_ZONES || NUM_ZONES < 1
+#error NUM_ZONES must be 1 to MAX_ZONES
+#endif
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initZones();
+float readZoneMoisture(uint8_t zone);
+void setZoneValve(uint8_t zone, bool open);
+bool isZoneValveOpen(uint8_t zone);
+uint8_t getOpenValveCount();
+void closeAllValves();
+
+#endif